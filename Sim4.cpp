@@ -10,10 +10,136 @@
 #include <sstream>
 #include <ctime>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <limits>
+#include <queue>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <charconv>
+#include <string_view>
+#include <array>
+#include <cerrno>
+#include <bit>
+#include <unordered_map>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/ioctl.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
+
+#if defined(__linux__)
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <csignal>
+#endif
 
 using namespace std;
 
+// ==================== CODEC DES INSTANTANÉS ====================
+// Encodage binaire brut (ordre des octets de la machine) : scalaires et
+// tableaux de types trivialement copiables recopiés tels quels, chaînes et
+// vecteurs préfixés par leur taille sur 64 bits. Le lecteur travaille sur un
+// tampon (fichier projeté ou instantané en mémoire) et échoue proprement sur
+// un tampon tronqué.
+struct SnapshotWriter {
+    string data;
+
+    template<class T> void put(const T &value) {
+        static_assert(is_trivially_copyable_v<T>);
+        data.append(reinterpret_cast<const char *>(&value), sizeof value);
+    }
+    void put(const string &text) {
+        put<uint64_t>(text.size());
+        data.append(text);
+    }
+    template<class A, class B> void put(const pair<A, B> &value) {
+        put(value.first);
+        put(value.second);
+    }
+    template<class T> void put(const vector<T> &values) {
+        put<uint64_t>(values.size());
+        if constexpr(is_trivially_copyable_v<T>) {
+            // Un vecteur vide peut ne pas avoir de tampon (data() nul)
+            if(!values.empty()) data.append(reinterpret_cast<const char *>(values.data()), values.size() * sizeof(T));
+        } else {
+            for(const auto &value : values) put(value);
+        }
+    }
+};
+
+struct SnapshotReader {
+    const char *p;
+    const char *end;
+
+    SnapshotReader(const char *data, size_t size) : p(data), end(data + size) {}
+
+    bool atEnd() const { return p == end; }
+
+    template<class T> bool get(T &value) {
+        static_assert(is_trivially_copyable_v<T>);
+        if((size_t)(end - p) < sizeof value) return false;
+        memcpy(&value, p, sizeof value);
+        p += sizeof value;
+        return true;
+    }
+    bool get(string &text) {
+        uint64_t size;
+        if(!get(size) || size > (size_t)(end - p)) return false;
+        text.assign(p, size);
+        p += size;
+        return true;
+    }
+    template<class A, class B> bool get(pair<A, B> &value) {
+        return get(value.first) && get(value.second);
+    }
+    template<class T> bool get(vector<T> &values) {
+        uint64_t size;
+        if(!get(size)) return false;
+        if constexpr(is_trivially_copyable_v<T>) {
+            if(size > (size_t)(end - p) / max<size_t>(1, sizeof(T))) return false;
+            values.resize(size);
+            if(size) memcpy(values.data(), p, size * sizeof(T));
+            p += size * sizeof(T);
+            return true;
+        } else {
+            if(size > (size_t)(end - p)) return false;     // au moins un octet par élément
+            values.resize(size);
+            for(auto &value : values) {
+                if(!get(value)) return false;
+            }
+            return true;
+        }
+    }
+};
+
 // ==================== STRUCTURES ====================
+// Besoins ou capacités par ressource (CPU, mémoire, E/S...) : au plus
+// MaxResources dimensions, les dimensions inutilisées à zéro. Taille fixe :
+// les noyaux DRF traitent les 8 voies d'un bloc, quel que soit le nombre de
+// ressources déclarées.
+constexpr size_t MaxResources = 8;
+struct alignas(32) ResourceVector {
+    double value[MaxResources] = {};
+
+    double &operator[](size_t r) { return value[r]; }
+    double operator[](size_t r) const { return value[r]; }
+    bool empty() const { return all_of(value, value + MaxResources, [](double x) { return x == 0; }); }
+};
+
 struct Process {
     string name;
     double demand;
@@ -25,6 +151,219 @@ struct Process {
     int endCycle = -1;
     double waitTime = 0.0;
     double basePriority;
+    int arrivalCycle = 0;   // admis au début de ce cycle (0 ou 1 : présent dès le départ)
+    ResourceVector need;    // consommation par unité allouée (DRF) ; vide : 1 sur la première ressource
+
+    // Temps de réponse : cycles de l'arrivée à la fin, bornes comprises
+    int responseCycles() const { return endCycle - max(arrivalCycle, 1) + 1; }
+
+    // Attente avant le premier service, en cycles ; jamais servi : attente
+    // jusqu'au cycle `current` compris
+    int waitCycles(int current) const {
+        return (startCycle != -1 ? startCycle : current + 1) - max(arrivalCycle, 1);
+    }
+};
+
+// Tas min indexé : éléments 0..n-1, clé comparée par < (égalité : plus petit
+// indice d'abord). Insertion, retrait du minimum ou d'un élément quelconque en
+// O(log n).
+template<class Key = double>
+struct IndexedMinHeap {
+    vector<int> items;
+    vector<int> position;       // place de l'élément dans items, -1 : absent
+    vector<Key> key;
+
+    void reset(size_t capacity) {
+        items.clear();
+        position.assign(capacity, -1);
+        key.assign(capacity, Key{});
+    }
+
+    // Nouvelles places en fin, absentes ; le contenu est conservé
+    void grow(size_t capacity) {
+        position.resize(capacity, -1);
+        key.resize(capacity, Key{});
+    }
+
+    void save(SnapshotWriter &out) const {
+        out.put(items);
+        out.put(position);
+        out.put(key);
+    }
+
+    bool load(SnapshotReader &in) {
+        return in.get(items) && in.get(position) && in.get(key) && position.size() == key.size();
+    }
+
+    bool empty() const { return items.empty(); }
+    bool contains(int i) const { return position[i] >= 0; }
+    int top() const { return items[0]; }
+    const Key &topKey() const { return key[items[0]]; }
+
+    void push(int i, const Key &k) {
+        key[i] = k;
+        position[i] = items.size();
+        items.push_back(i);
+        siftUp(position[i]);
+    }
+
+    int pop() {
+        int i = items[0];
+        erase(i);
+        return i;
+    }
+
+    void erase(int i) {
+        int at = position[i];
+        if(at < 0) return;
+        int last = items.back();
+        items.pop_back();
+        position[i] = -1;
+        if(last == i) return;
+        items[at] = last;
+        position[last] = at;
+        siftUp(at);
+        siftDown(position[last]);
+    }
+
+private:
+    bool before(int a, int b) const { return key[a] < key[b] || (key[a] == key[b] && a < b); }
+
+    void siftUp(int at) {
+        int i = items[at];
+        while(at > 0) {
+            int parent = (at - 1) / 2;
+            if(!before(i, items[parent])) break;
+            items[at] = items[parent];
+            position[items[at]] = at;
+            at = parent;
+        }
+        items[at] = i;
+        position[i] = at;
+    }
+
+    void siftDown(int at) {
+        int n = items.size();
+        int i = items[at];
+        while(true) {
+            int child = 2 * at + 1;
+            if(child >= n) break;
+            if(child + 1 < n && before(items[child + 1], items[child])) child++;
+            if(!before(items[child], i)) break;
+            items[at] = items[child];
+            position[items[at]] = at;
+            at = child;
+        }
+        items[at] = i;
+        position[i] = at;
+    }
+};
+
+// État de la politique WFQ (WF2Q+) d'une file, construit à sa première passe.
+// Chaque processus vivant porte l'étiquette de début virtuel de sa prochaine
+// tranche ; il est éligible quand elle ne dépasse pas le temps virtuel de la
+// file (tas `eligible`, clé : fin virtuelle), sinon il attend (tas `waiting`,
+// clé : début). Les entrées et sorties de processus hors de la politique
+// (arrivées, retraits) passent par arrive() / remove().
+struct FairQueueState {
+    bool initialized = false;
+    double virtualTime = 0.0;
+    double weightSum = 0.0;         // somme des poids des processus étiquetés
+    vector<double> start;
+    vector<double> weight;          // poids retenu à l'étiquetage, 0 : hors des tas
+    IndexedMinHeap<> eligible;
+    IndexedMinHeap<> waiting;
+    vector<int> arrived;            // à étiqueter à la prochaine passe
+
+    void reset(size_t n) {
+        initialized = true;
+        weightSum = 0.0;
+        start.assign(n, 0.0);
+        weight.assign(n, 0.0);
+        eligible.reset(n);
+        waiting.reset(n);
+        arrived.clear();
+    }
+
+    void grow(size_t n) {
+        if(!initialized) return;
+        start.resize(n, 0.0);
+        weight.resize(n, 0.0);
+        eligible.grow(n);
+        waiting.grow(n);
+    }
+
+    void arrive(int i) { if(initialized) arrived.push_back(i); }
+
+    void save(SnapshotWriter &out) const {
+        out.put(initialized);
+        out.put(virtualTime);
+        out.put(weightSum);
+        out.put(start);
+        out.put(weight);
+        eligible.save(out);
+        waiting.save(out);
+        out.put(arrived);
+    }
+
+    bool load(SnapshotReader &in) {
+        return in.get(initialized) && in.get(virtualTime) && in.get(weightSum) && in.get(start) &&
+               in.get(weight) && eligible.load(in) && waiting.load(in) && in.get(arrived);
+    }
+
+    void remove(int i) {
+        if(!initialized || weight[i] == 0) return;
+        eligible.erase(i);
+        waiting.erase(i);
+        weightSum -= weight[i];
+        weight[i] = 0.0;
+    }
+};
+
+// État de la politique PRIO d'une file : tas des processus vivants par
+// priorité effective décroissante. Le vieillissement est paresseux : au cycle
+// c, la priorité effective vaut base + taux × (c − dernier service), donc
+// l'ordre entre deux processus ne dépend pas de c. La clé du tas,
+// taux × dernier service − base, n'est recalculée qu'au service ; à clé égale,
+// le processus remis au tas le plus tôt passe d'abord (ronde).
+struct PriorityQueueState {
+    bool initialized = false;
+    double rate = 0.0;              // taux de vieillissement des clés en place
+    uint64_t sequence = 0;          // ordre de remise au tas
+    vector<int> lastService;        // cycle du dernier service (ou de l'arrivée)
+    IndexedMinHeap<pair<double, uint64_t>> heap;
+    vector<int> arrived;            // à placer à la prochaine passe
+
+    void reset(size_t n, double agingRate) {
+        initialized = true;
+        rate = agingRate;
+        lastService.assign(n, 0);
+        heap.reset(n);
+        arrived.clear();
+    }
+
+    void grow(size_t n) {
+        if(!initialized) return;
+        lastService.resize(n, 0);
+        heap.grow(n);
+    }
+
+    void arrive(int i) { if(initialized) arrived.push_back(i); }
+    void remove(int i) { if(initialized) heap.erase(i); }
+
+    void save(SnapshotWriter &out) const {
+        out.put(initialized);
+        out.put(rate);
+        out.put(sequence);
+        out.put(lastService);
+        heap.save(out);
+        out.put(arrived);
+    }
+
+    bool load(SnapshotReader &in) {
+        return in.get(initialized) && in.get(rate) && in.get(sequence) && in.get(lastService) &&
+               heap.load(in) && in.get(arrived);
+    }
 };
 
 struct Queue {
@@ -37,613 +376,7309 @@ struct Queue {
     double quota = 0.0;
     string color;
     string emoji;
+    int firstSlot = 0;      // début de la plage de la file dans la ProcessTable
+    int policyId = -1;      // politique résolue dans le PolicyRegistry à l'ajout
+    int group = -1;         // groupe parent dans la hiérarchie (-1 : racine)
+
+    // Index des processus non terminés : liste chaînée circulaire intrusive,
+    // dans l'ordre des processus. Retirer un processus terminé coûte O(1).
+    vector<int> nextLive;
+    vector<int> prevLive;
+    int headLive = -1;
+    int liveCount = 0;
+
+    vector<int> freeSlots;  // places libres de la plage (mode service), réutilisées à l'ajout
+
+    FairQueueState fair;    // politique WFQ seulement
+    PriorityQueueState prio;    // politique PRIO seulement
 };
 
+// Statistiques d'un cycle. Dans l'historique sous-échantillonné, une entrée
+// couvre cycleSpan cycles à partir de cycleNumber : compteurs et allocation
+// cumulés, utilisation moyenne.
 struct CycleStats {
     int cycleNumber;
-    map<string, double> queueAllocations;
-    map<string, vector<pair<string, double>>> processAllocations;
     int activeProcesses;
     double totalAllocated;
     double utilization;
+    int finishedProcesses = 0;
+    int cycleSpan = 1;
 };
 
-// ==================== CLASSE UTILITAIRE ====================
-class Display {
-public:
-    static void clearScreen() {
-        #ifdef _WIN32
-            system("cls");
-        #else
-            system("clear");
-        #endif
-    }
+// Résumé d'une exécution sans interface (mode batch)
+struct RunSummary {
+    int cycles = 0;
+    double wallSeconds = 0.0;
+    double cyclesPerSecond = 0.0;
+    double meanUtilization = 0.0;       // moyenne sur les cycles, en %
+    double meanResponse = 0.0;          // temps de réponse moyen des terminés, en cycles
+    long long allocations = 0;          // allocations à un processus, tous cycles confondus
+    vector<int> queueCompletion;        // dernier cycle de fin par file (-1 : inachevée)
+    double meanWait = 0.0;              // attente avant le premier service, processus arrivés
+    int maxWait = 0;
+    map<int, pair<double, int>> waitByPriority;     // priorité de base -> (moyenne, max)
 
-    static void printBanner() {
-        cout << "\033[1;36m"; // Cyan bold
-        cout << "\n╔═══════════════════════════════════════════════════════════════════════╗\n";
-        cout << "║                                                                       ║\n";
-        cout << "║          🚀        SIMULATEUR CAP-PRO-RATA                🚀          ║\n";
-        cout << "║                                                                       ║\n";
-        cout << "║              Allocation Multi-Niveaux de Ressources                   ║\n";
-        cout << "║                  Akamba Biyembe aka Artemis                           ║\n";
-        cout << "║                                                                       ║\n";
-        cout << "╚═══════════════════════════════════════════════════════════════════════╝\n";
-        cout << "\033[0m"; // Reset
+    // Retour d'une variante calculée dans un processus fils
+    void save(SnapshotWriter &out) const {
+        out.put(cycles);
+        out.put(wallSeconds);
+        out.put(cyclesPerSecond);
+        out.put(meanUtilization);
+        out.put(meanResponse);
+        out.put(allocations);
+        out.put(queueCompletion);
+        out.put(meanWait);
+        out.put(maxWait);
+        out.put(vector<pair<int, pair<double, int>>>(waitByPriority.begin(), waitByPriority.end()));
     }
 
-    static void printHeader(const string& title, int cycle = -1) {
-        cout << "\n\033[1;34m"; // Blue bold
-        cout << "╔═══════════════════════════════════════════════════════════════════════╗\n";
-        if(cycle >= 0) {
-            cout << "║  " << title << " " << cycle << string(58 - title.length() - to_string(cycle).length(), ' ') << "║\n";
-        } else {
-            cout << "║  " << title << string(68 - title.length(), ' ') << "║\n";
+    bool load(SnapshotReader &in) {
+        vector<pair<int, pair<double, int>>> waits;
+        if(!(in.get(cycles) && in.get(wallSeconds) && in.get(cyclesPerSecond) && in.get(meanUtilization) &&
+             in.get(meanResponse) && in.get(allocations) && in.get(queueCompletion) && in.get(meanWait) &&
+             in.get(maxWait) && in.get(waits))) {
+            return false;
         }
-        cout << "╚═══════════════════════════════════════════════════════════════════════╝\n";
-        cout << "\033[0m";
+        waitByPriority = map<int, pair<double, int>>(waits.begin(), waits.end());
+        return true;
     }
+};
+
+// ==================== TABLE DES PROCESSUS (SoA) ====================
+// Colonnes contiguës pour les champs chauds du moteur ; les noms vivent dans
+// une table à part. Les processus d'une file occupent une plage contiguë
+// [firstSlot, firstSlot + processes.size()).
+struct ProcessTable {
+    vector<double> remaining;
+    vector<double> allocated;
+    vector<uint64_t> finishedMask;   // 1 bit par processus
+    vector<int32_t> queueId;
+    vector<string> names;
+
+    size_t size() const { return remaining.size(); }
 
-    static void printSeparator(char style = '─') {
-        cout << "\033[0;90m"; // Dark gray
-        for(int i = 0; i < 75; i++) cout << style;
-        cout << "\033[0m\n";
+    int append(const Process &p, int queue) {
+        int slot = remaining.size();
+        remaining.push_back(p.remaining);
+        allocated.push_back(p.allocated);
+        queueId.push_back(queue);
+        names.push_back(p.name);
+        if(finishedMask.size() * 64 < remaining.size()) finishedMask.push_back(0);
+        if(p.finished) setFinished(slot);
+        return slot;
     }
 
-    static string getStatusEmoji(bool finished) {
-        return finished ? "\033[1;32m✅\033[0m" : "\033[1;33m⏳\033[0m";
+    // Recopie d'un slot d'une autre table (réagencement des plages)
+    void appendFrom(const ProcessTable &other, size_t from, int queue) {
+        size_t slot = remaining.size();
+        remaining.push_back(other.remaining[from]);
+        allocated.push_back(other.allocated[from]);
+        queueId.push_back(queue);
+        names.push_back(other.names[from]);
+        if(finishedMask.size() * 64 < remaining.size()) finishedMask.push_back(0);
+        if(other.isFinished(from)) setFinished(slot);
     }
 
-    static string getProgressBar(double current, double total, int width = 20) {
-        int filled = (int)((current / total) * width);
-        string bar = "\033[1;32m[\033[0m";
-        for(int i = 0; i < width; i++) {
-            if(i < filled) bar += "\033[1;32m█\033[0m";
-            else bar += "\033[0;90m░\033[0m";
-        }
-        bar += "\033[1;32m]\033[0m";
-        return bar;
+    // Deux files voisines peuvent partager un mot du masque : lecture et
+    // écriture sont atomiques (relâchées) pour que les files soient traitées
+    // en parallèle sans verrou. Les sommes vectorisées (sumUnfinished) ne
+    // tournent qu'entre les passes et lisent le masque directement.
+    bool isFinished(size_t slot) const {
+        uint64_t word = atomic_ref<uint64_t>(const_cast<uint64_t &>(finishedMask[slot >> 6])).load(memory_order_relaxed);
+        return (word >> (slot & 63)) & 1;
     }
 
-    static void printResourceGrid(double totalResource, const vector<Queue>& queues, int gridWidth = 60) {
-        cout << "\n\033[1;35m📊 DISTRIBUTION DES RESSOURCES\033[0m\n";
-        cout << "   Total disponible: \033[1;33m" << fixed << setprecision(1) 
-             << totalResource << " unités\033[0m\n\n";
-        
-        double totalWeight = 0;
-        for(const auto& q : queues) totalWeight += q.weight;
-        
-        cout << "   ┌";
-        for(int i = 0; i < gridWidth; i++) cout << "─";
-        cout << "┐\n   │";
+    void setFinished(size_t slot) {
+        atomic_ref<uint64_t>(finishedMask[slot >> 6]).fetch_or(uint64_t(1) << (slot & 63), memory_order_relaxed);
+    }
 
-        for(const auto& q : queues) {
-            int cells = (int)((q.weight / totalWeight) * gridWidth);
-            string colorCode = q.color;
-            
-            for(int i = 0; i < cells; i++) {
-                if(i == cells/2) cout << q.emoji;
-                else cout << colorCode << "█\033[0m";
+    // Un processus pas encore arrivé est marqué comme terminé (hors des
+    // vivants et des demandes) jusqu'à son admission
+    void clearFinished(size_t slot) {
+        atomic_ref<uint64_t>(finishedMask[slot >> 6]).fetch_and(~(uint64_t(1) << (slot & 63)), memory_order_relaxed);
+    }
+
+    // Dernier slot non terminé de [begin, end), -1 s'il n'y en a pas :
+    // 64 slots par mot du masque (hors passes parallèles)
+    long lastUnfinished(size_t begin, size_t end) const {
+        while(end > begin) {
+            size_t word = (end - 1) >> 6;
+            uint64_t live = ~finishedMask[word] & ((uint64_t(2) << ((end - 1) & 63)) - 1);
+            if(live) {
+                size_t slot = (word << 6) + 63 - countl_zero(live);
+                return slot >= begin ? (long)slot : -1;
             }
+            end = word << 6;
         }
-        
-        cout << "│\n   └";
-        for(int i = 0; i < gridWidth; i++) cout << "─";
-        cout << "┘\n\n";
+        return -1;
+    }
+};
 
-        // Légende améliorée
-        cout << "   \033[1;37mLÉGENDE:\033[0m\n";
-        for(const auto& q : queues) {
-            double quota = (q.weight / totalWeight) * totalResource;
-            double percentage = (q.weight / totalWeight) * 100;
-            cout << "   " << q.emoji << " " << q.color << q.name << "\033[0m"
-                 << " │ Poids: " << fixed << setprecision(2) << q.weight
-                 << " │ Quota: " << setprecision(1) << quota << " unités"
-                 << " │ Part: " << setprecision(1) << percentage << "%\n";
+// ==================== NOYAUX VECTORISÉS ====================
+// AVX2, SSE2 ou scalaire selon la compilation. Les trois chemins accumulent
+// sur 4 voies (élément i -> voie i % 4) et les combinent dans le même ordre.
+namespace Kernels {
+
+// 4 bits « terminé » à partir de la position slot (peut chevaucher deux mots)
+inline unsigned finishedBits4(const uint64_t *mask, size_t slot) {
+    size_t word = slot >> 6, bit = slot & 63;
+    uint64_t bits = mask[word] >> bit;
+    if(bit > 60) bits |= mask[word + 1] << (64 - bit);
+    return bits & 0xF;
+}
+
+// Somme de values[begin, end) en ignorant les processus terminés
+inline double sumUnfinished(const double *values, const uint64_t *mask, size_t begin, size_t end) {
+    size_t i = begin;
+#if defined(__AVX2__)
+    __m256d acc = _mm256_setzero_pd();
+    const __m256i select = _mm256_set_epi64x(8, 4, 2, 1);
+    for(; i + 4 <= end; i += 4) {
+        __m256i bits = _mm256_set1_epi64x(finishedBits4(mask, i));
+        __m256i live = _mm256_cmpeq_epi64(_mm256_and_si256(bits, select), _mm256_setzero_si256());
+        acc = _mm256_add_pd(acc, _mm256_and_pd(_mm256_loadu_pd(values + i), _mm256_castsi256_pd(live)));
+    }
+    alignas(32) double lane[4];
+    _mm256_store_pd(lane, acc);
+#elif defined(__SSE2__)
+    __m128d lo = _mm_setzero_pd(), hi = _mm_setzero_pd();
+    for(; i + 4 <= end; i += 4) {
+        unsigned bits = finishedBits4(mask, i);
+        __m128d mlo = _mm_castsi128_pd(_mm_set_epi64x((bits & 2) ? 0 : -1, (bits & 1) ? 0 : -1));
+        __m128d mhi = _mm_castsi128_pd(_mm_set_epi64x((bits & 8) ? 0 : -1, (bits & 4) ? 0 : -1));
+        lo = _mm_add_pd(lo, _mm_and_pd(_mm_loadu_pd(values + i), mlo));
+        hi = _mm_add_pd(hi, _mm_and_pd(_mm_loadu_pd(values + i + 2), mhi));
+    }
+    alignas(16) double lane[4];
+    _mm_store_pd(lane, lo);
+    _mm_store_pd(lane + 2, hi);
+#else
+    double lane[4] = {0, 0, 0, 0};
+    for(; i + 4 <= end; i += 4) {
+        unsigned bits = finishedBits4(mask, i);
+        for(int j = 0; j < 4; j++) {
+            if(!(bits & (1u << j))) lane[j] += values[i + j];
         }
     }
+#endif
+    for(size_t j = 0; i < end; i++, j++) {
+        if(!((mask[i >> 6] >> (i & 63)) & 1)) lane[j] += values[i];
+    }
+    return (lane[0] + lane[1]) + (lane[2] + lane[3]);
+}
 
-    static void printAllocationTable(const vector<Queue>& queues) {
-        cout << "\n\033[1;36m📋 TABLEAU D'ALLOCATION DÉTAILLÉ\033[0m\n\n";
-        
-        for(const auto& q : queues) {
-            cout << "  " << q.emoji << " " << q.color << "━━━ " << q.name 
-                 << " [" << q.policy << "] ━━━\033[0m\n";
-            cout << "  ┌────────────┬──────────┬──────────┬──────────┬──────────┬────────┐\n";
-            cout << "  │ Processus  │ Demande  │ Restant  │  Alloué  │ Progress │  État  │\n";
-            cout << "  ├────────────┼──────────┼──────────┼──────────┼──────────┼────────┤\n";
-            
-            for(const auto& p : q.processes) {
-                cout << "  │ " << setw(10) << left << p.name 
-                     << " │ " << setw(8) << right << fixed << setprecision(1) << p.demand
-                     << " │ " << setw(8) << p.remaining
-                     << " │ " << setw(8) << p.allocated
-                     << " │ " << getProgressBar(p.allocated, p.demand, 8)
-                     << " │ " << getStatusEmoji(p.finished) << "   │\n";
-            }
-            cout << "  └────────────┴──────────┴──────────┴──────────┴──────────┴────────┘\n";
-            
-            // Statistiques de la file
-            int completed = 0, total = q.processes.size();
-            double totalDemand = 0, totalAllocated = 0;
-            for(const auto& p : q.processes) {
-                if(p.finished) completed++;
-                totalDemand += p.demand;
-                totalAllocated += p.allocated;
-            }
-            
-            cout << "  📊 Stats: " << completed << "/" << total << " terminés"
-                 << " │ Total alloué: " << fixed << setprecision(1) << totalAllocated 
-                 << "/" << totalDemand << " unités\n\n";
-        }
+// Somme de weights[i] * demands[i]
+inline double weightedTotal(const double *weights, const double *demands, size_t n) {
+    size_t i = 0;
+#if defined(__AVX2__)
+    __m256d acc = _mm256_setzero_pd();
+    for(; i + 4 <= n; i += 4) {
+        acc = _mm256_add_pd(acc, _mm256_mul_pd(_mm256_loadu_pd(weights + i), _mm256_loadu_pd(demands + i)));
     }
+    alignas(32) double lane[4];
+    _mm256_store_pd(lane, acc);
+#elif defined(__SSE2__)
+    __m128d lo = _mm_setzero_pd(), hi = _mm_setzero_pd();
+    for(; i + 4 <= n; i += 4) {
+        lo = _mm_add_pd(lo, _mm_mul_pd(_mm_loadu_pd(weights + i), _mm_loadu_pd(demands + i)));
+        hi = _mm_add_pd(hi, _mm_mul_pd(_mm_loadu_pd(weights + i + 2), _mm_loadu_pd(demands + i + 2)));
+    }
+    alignas(16) double lane[4];
+    _mm_store_pd(lane, lo);
+    _mm_store_pd(lane + 2, hi);
+#else
+    double lane[4] = {0, 0, 0, 0};
+    for(; i + 4 <= n; i += 4) {
+        for(int j = 0; j < 4; j++) lane[j] += weights[i + j] * demands[i + j];
+    }
+#endif
+    for(size_t j = 0; i < n; i++, j++) lane[j] += weights[i] * demands[i];
+    return (lane[0] + lane[1]) + (lane[2] + lane[3]);
+}
 
-    static void printDetailedProgress(const vector<Queue>& queues, double totalResource) {
-        cout << "\n\033[1;33m🎯 PROGRESSION DÉTAILLÉE PAR PROCESSUS\033[0m\n\n";
-        
-        for(const auto& q : queues) {
-            cout << "  " << q.emoji << " " << q.color << q.name << "\033[0m\n";
-            
-            for(const auto& p : q.processes) {
-                double progress = (p.allocated / p.demand) * 100;
-                cout << "    ├─ " << setw(12) << left << p.name << " ";
-                
-                // Barre de progression colorée
-                int barWidth = 30;
-                int filled = (int)((progress / 100.0) * barWidth);
-                cout << "[";
-                for(int i = 0; i < barWidth; i++) {
-                    if(i < filled) {
-                        if(progress >= 100) cout << "\033[1;32m█\033[0m";
-                        else if(progress >= 66) cout << "\033[1;33m█\033[0m";
-                        else if(progress >= 33) cout << "\033[1;36m█\033[0m";
-                        else cout << "\033[1;31m█\033[0m";
-                    } else {
-                        cout << "\033[0;90m░\033[0m";
-                    }
-                }
-                cout << "] " << fixed << setprecision(1) << progress << "%";
-                
-                if(p.finished) {
-                    cout << " \033[1;32m✓ COMPLÉTÉ\033[0m";
-                }
-                cout << "\n";
-            }
-            cout << "\n";
+// quotas[i] = (weights[i] * demands[i] / total) * resource, 0 si total nul
+inline void computeQuotas(const double *weights, const double *demands, double total,
+                          double resource, double *quotas, size_t n) {
+    if(total <= 0) {
+        fill(quotas, quotas + n, 0.0);
+        return;
+    }
+    size_t i = 0;
+#if defined(__AVX2__)
+    __m256d t = _mm256_set1_pd(total), r = _mm256_set1_pd(resource);
+    for(; i + 4 <= n; i += 4) {
+        __m256d wd = _mm256_mul_pd(_mm256_loadu_pd(weights + i), _mm256_loadu_pd(demands + i));
+        _mm256_storeu_pd(quotas + i, _mm256_mul_pd(_mm256_div_pd(wd, t), r));
+    }
+#elif defined(__SSE2__)
+    __m128d t = _mm_set1_pd(total), r = _mm_set1_pd(resource);
+    for(; i + 2 <= n; i += 2) {
+        __m128d wd = _mm_mul_pd(_mm_loadu_pd(weights + i), _mm_loadu_pd(demands + i));
+        _mm_storeu_pd(quotas + i, _mm_mul_pd(_mm_div_pd(wd, t), r));
+    }
+#endif
+    for(; i < n; i++) quotas[i] = (weights[i] * demands[i] / total) * resource;
+}
+
+// Plus grand a tel que a × need <= free sur chaque ressource ; les ressources
+// dont need est nul ne limitent pas (+inf si need est vide)
+inline double fitScale(const ResourceVector &free, const ResourceVector &need) {
+    const double inf = numeric_limits<double>::infinity();
+#if defined(__AVX2__)
+    __m256d best = _mm256_set1_pd(inf);
+    for(size_t r = 0; r < MaxResources; r += 4) {
+        __m256d n = _mm256_load_pd(need.value + r);
+        __m256d ratio = _mm256_div_pd(_mm256_load_pd(free.value + r), n);
+        __m256d unused = _mm256_cmp_pd(n, _mm256_setzero_pd(), _CMP_EQ_OQ);
+        best = _mm256_min_pd(best, _mm256_blendv_pd(ratio, _mm256_set1_pd(inf), unused));
+    }
+    alignas(32) double lane[4];
+    _mm256_store_pd(lane, best);
+#elif defined(__SSE2__)
+    __m128d lo = _mm_set1_pd(inf), hi = lo;
+    for(size_t r = 0; r < MaxResources; r += 4) {
+        __m128d n0 = _mm_load_pd(need.value + r), n1 = _mm_load_pd(need.value + r + 2);
+        __m128d u0 = _mm_cmpeq_pd(n0, _mm_setzero_pd()), u1 = _mm_cmpeq_pd(n1, _mm_setzero_pd());
+        __m128d r0 = _mm_div_pd(_mm_load_pd(free.value + r), n0);
+        __m128d r1 = _mm_div_pd(_mm_load_pd(free.value + r + 2), n1);
+        lo = _mm_min_pd(lo, _mm_or_pd(_mm_and_pd(u0, _mm_set1_pd(inf)), _mm_andnot_pd(u0, r0)));
+        hi = _mm_min_pd(hi, _mm_or_pd(_mm_and_pd(u1, _mm_set1_pd(inf)), _mm_andnot_pd(u1, r1)));
+    }
+    alignas(16) double lane[4];
+    _mm_store_pd(lane, lo);
+    _mm_store_pd(lane + 2, hi);
+#else
+    double lane[4] = {inf, inf, inf, inf};
+    for(size_t r = 0; r < MaxResources; r++) {
+        if(need[r] != 0) lane[r % 4] = min(lane[r % 4], free[r] / need[r]);
+    }
+#endif
+    return min(min(lane[0], lane[1]), min(lane[2], lane[3]));
+}
+
+// free -= a × need, borné à 0 (sans FMA : même arrondi sur les trois chemins)
+inline void subtractScaled(ResourceVector &free, const ResourceVector &need, double a) {
+#if defined(__AVX2__)
+    __m256d scale = _mm256_set1_pd(a);
+    for(size_t r = 0; r < MaxResources; r += 4) {
+        __m256d left = _mm256_sub_pd(_mm256_load_pd(free.value + r), _mm256_mul_pd(scale, _mm256_load_pd(need.value + r)));
+        _mm256_store_pd(free.value + r, _mm256_max_pd(left, _mm256_setzero_pd()));
+    }
+#elif defined(__SSE2__)
+    __m128d scale = _mm_set1_pd(a);
+    for(size_t r = 0; r < MaxResources; r += 2) {
+        __m128d left = _mm_sub_pd(_mm_load_pd(free.value + r), _mm_mul_pd(scale, _mm_load_pd(need.value + r)));
+        _mm_store_pd(free.value + r, _mm_max_pd(left, _mm_setzero_pd()));
+    }
+#else
+    for(size_t r = 0; r < MaxResources; r++) free[r] = max(free[r] - a * need[r], 0.0);
+#endif
+}
+
+// max(need × inverseCapacity) : part dominante d'une unité allouée
+inline double dominantShare(const ResourceVector &need, const ResourceVector &inverseCapacity) {
+#if defined(__AVX2__)
+    __m256d best = _mm256_mul_pd(_mm256_load_pd(need.value), _mm256_load_pd(inverseCapacity.value));
+    best = _mm256_max_pd(best, _mm256_mul_pd(_mm256_load_pd(need.value + 4), _mm256_load_pd(inverseCapacity.value + 4)));
+    alignas(32) double lane[4];
+    _mm256_store_pd(lane, best);
+#elif defined(__SSE2__)
+    __m128d lo = _mm_mul_pd(_mm_load_pd(need.value), _mm_load_pd(inverseCapacity.value));
+    __m128d hi = _mm_mul_pd(_mm_load_pd(need.value + 2), _mm_load_pd(inverseCapacity.value + 2));
+    lo = _mm_max_pd(lo, _mm_mul_pd(_mm_load_pd(need.value + 4), _mm_load_pd(inverseCapacity.value + 4)));
+    hi = _mm_max_pd(hi, _mm_mul_pd(_mm_load_pd(need.value + 6), _mm_load_pd(inverseCapacity.value + 6)));
+    alignas(16) double lane[4];
+    _mm_store_pd(lane, lo);
+    _mm_store_pd(lane + 2, hi);
+#else
+    double lane[4] = {0, 0, 0, 0};
+    for(size_t r = 0; r < MaxResources; r++) lane[r % 4] = max(lane[r % 4], need[r] * inverseCapacity[r]);
+#endif
+    return max(max(lane[0], lane[1]), max(lane[2], lane[3]));
+}
+
+} // namespace Kernels
+
+// ==================== STRUCTURES D'INDEX ====================
+// Arbre de Fenwick sur des indicateurs 0/1 : rang et k-ième élément en O(log n)
+struct FenwickTree {
+    vector<int> tree;
+    int highBit = 1;
+
+    void build(const vector<char> &flags) {
+        int n = flags.size();
+        tree.assign(n + 1, 0);
+        for(int i = 0; i < n; i++) {
+            tree[i + 1] += flags[i];
+            int parent = (i + 1) + ((i + 1) & -(i + 1));
+            if(parent <= n) tree[parent] += tree[i + 1];
         }
+        highBit = 1;
+        while(highBit * 2 <= n) highBit *= 2;
     }
 
-    static void printCycleMetrics(int cycle, const CycleStats& stats, double totalResource) {
-        cout << "\n\033[1;35m📈 MÉTRIQUES DU CYCLE " << cycle << "\033[0m\n";
-        cout << "  ┌─────────────────────────────────────────────┐\n";
-        cout << "  │ Processus actifs    : " << setw(18) << right << stats.activeProcesses << "  │\n";
-        cout << "  │ Ressources allouées : " << setw(15) << fixed << setprecision(2) 
-             << stats.totalAllocated << " unités │\n";
-        cout << "  │ Taux d'utilisation  : " << setw(17) << setprecision(1) 
-             << stats.utilization << "% │\n";
-        cout << "  └─────────────────────────────────────────────┘\n";
+    void add(int i, int delta) {
+        for(i++; i < (int)tree.size(); i += i & -i) tree[i] += delta;
     }
 
-    static void printWaitingAnimation(int duration_ms) {
-        const string anim[] = {"⠋", "⠙", "⠹", "⠸", "⠼", "⠴", "⠦", "⠧", "⠇", "⠏"};
-        int steps = duration_ms / 100;
-        
-        for(int i = 0; i < steps; i++) {
-            cout << "\r  " << anim[i % 10] << " Allocation en cours..." << flush;
-            this_thread::sleep_for(chrono::milliseconds(100));
+    // Nombre d'éléments présents dans [0, i)
+    int prefix(int i) const {
+        int sum = 0;
+        for(; i > 0; i -= i & -i) sum += tree[i];
+        return sum;
+    }
+
+    // Indice du k-ième élément présent (k à partir de 0)
+    int kth(int k) const {
+        int pos = 0;
+        for(int step = highBit; step > 0; step >>= 1) {
+            if(pos + step < (int)tree.size() && tree[pos + step] <= k) {
+                pos += step;
+                k -= tree[pos];
+            }
         }
-        cout << "\r  ✓ Allocation terminée!            \n";
+        return pos;
     }
 };
 
-// ==================== CLASSE PRINCIPALE ====================
-class ResourceAllocator {
+// Arbre de segments (minimum + ajout sur intervalle, propagation paresseuse).
+// Les entrées absentes valent +inf et le restent.
+struct MinAddSegmentTree {
+    int n = 0;
+    vector<double> minValue;
+    vector<double> pending;
+
+    void build(const vector<double> &values) {
+        n = max<int>(1, values.size());
+        minValue.assign(4 * n, numeric_limits<double>::infinity());
+        pending.assign(4 * n, 0.0);
+        if(!values.empty()) build(1, 0, n, values);
+    }
+
+    void add(int l, int r, double delta) { if(l < r) add(1, 0, n, l, r, delta); }
+    void set(int i, double value) { set(1, 0, n, i, value); }
+    double get(int i) { return get(1, 0, n, i); }
+
+    // Premier indice de [l, r) dont la valeur est <= threshold, -1 sinon
+    int findFirstAtMost(int l, int r, double threshold) {
+        return l < r ? findFirst(1, 0, n, l, r, threshold) : -1;
+    }
+
 private:
-    double totalResource;
-    vector<Queue> queues;
-    vector<CycleStats> history;
-    ofstream logFile;
-    ofstream jsonFile;
-    int currentCycle = 0;
-    bool useAging = true;
-    double agingFactor = 0.05;
+    void build(int node, int lo, int hi, const vector<double> &values) {
+        if(hi - lo == 1) {
+            minValue[node] = lo < (int)values.size() ? values[lo] : numeric_limits<double>::infinity();
+            return;
+        }
+        int mid = (lo + hi) / 2;
+        build(2 * node, lo, mid, values);
+        build(2 * node + 1, mid, hi, values);
+        minValue[node] = min(minValue[2 * node], minValue[2 * node + 1]);
+    }
+
+    void apply(int node, double delta) {
+        minValue[node] += delta;
+        pending[node] += delta;
+    }
+
+    void push(int node) {
+        if(pending[node] != 0.0) {
+            apply(2 * node, pending[node]);
+            apply(2 * node + 1, pending[node]);
+            pending[node] = 0.0;
+        }
+    }
+
+    void add(int node, int lo, int hi, int l, int r, double delta) {
+        if(r <= lo || hi <= l) return;
+        if(l <= lo && hi <= r) { apply(node, delta); return; }
+        push(node);
+        int mid = (lo + hi) / 2;
+        add(2 * node, lo, mid, l, r, delta);
+        add(2 * node + 1, mid, hi, l, r, delta);
+        minValue[node] = min(minValue[2 * node], minValue[2 * node + 1]);
+    }
+
+    void set(int node, int lo, int hi, int i, double value) {
+        if(hi - lo == 1) { minValue[node] = value; pending[node] = 0.0; return; }
+        push(node);
+        int mid = (lo + hi) / 2;
+        if(i < mid) set(2 * node, lo, mid, i, value);
+        else set(2 * node + 1, mid, hi, i, value);
+        minValue[node] = min(minValue[2 * node], minValue[2 * node + 1]);
+    }
+
+    double get(int node, int lo, int hi, int i) {
+        if(hi - lo == 1) return minValue[node];
+        push(node);
+        int mid = (lo + hi) / 2;
+        return i < mid ? get(2 * node, lo, mid, i) : get(2 * node + 1, mid, hi, i);
+    }
 
+    int findFirst(int node, int lo, int hi, int l, int r, double threshold) {
+        if(r <= lo || hi <= l || minValue[node] > threshold) return -1;
+        if(hi - lo == 1) return lo;
+        push(node);
+        int mid = (lo + hi) / 2;
+        int found = findFirst(2 * node, lo, mid, l, r, threshold);
+        return found != -1 ? found : findFirst(2 * node + 1, mid, hi, l, r, threshold);
+    }
+};
+
+// ==================== HIÉRARCHIE DES FILES ====================
+// Groupes imbriqués (locataire → équipe → ...) dont les feuilles sont les
+// files. La part d'un nœud est divisée entre ses enfants au prorata de
+// poids × demande du sous-arbre, comme les quotas à plat entre files : sous la
+// seule racine, on retrouve computeQuotas. Les groupes sont aplatis en
+// préordre (sous-arbre de g : plage [g, subtreeEnd[g]), enfants parcourus par
+// sauts) et les files rangées par groupe (plage [leafBegin[g], leafEnd[g])).
+// Chaque groupe tient son échelle part / (somme poids × demande de ses
+// enfants) : le quota d'une file est poids × demande × échelle de son groupe,
+// lu à la demande. evaluate() :
+//   - compare demande et poids de chaque file aux valeurs retenues (balayage
+//     séquentiel, ou seulement les files d'une liste de changements) et marque
+//     le groupe parent des files modifiées ;
+//   - remontée (préordre inverse) : seul un groupe marqué resomme ses enfants
+//     et marque son parent ;
+//   - descente (préordre) : les échelles ne sont recalculées que sous un
+//     groupe marqué ou dont la part a changé, les autres sous-arbres sont
+//     sautés d'un bloc. Aucun parcours des files hors des groupes marqués.
+class QueueHierarchy {
 public:
-    ResourceAllocator(double totalRes) : totalResource(totalRes) {
-        time_t now = time(0);
-        tm *ltm = localtime(&now);
-        
-        logFile.open("allocation_log.txt");
-        jsonFile.open("allocation_data.json");
-        
-        logFile << "═══════════════════════════════════════════════════════\n";
-        logFile << "  SIMULATION CAP-PRO-RATA - LOG DÉTAILLÉ\n";
-        logFile << "═══════════════════════════════════════════════════════\n";
-        logFile << "Date de simulation: " << asctime(ltm);
-        logFile << "Ressource totale: " << totalResource << " unités\n";
-        logFile << "Aging activé: " << (useAging ? "OUI" : "NON") << "\n\n";
-        
-        jsonFile << "{\n  \"simulation\": {\n";
-        jsonFile << "    \"totalResource\": " << totalResource << ",\n";
-        jsonFile << "    \"timestamp\": \"" << asctime(ltm) << "\",\n";
-        jsonFile << "    \"cycles\": [\n";
+    // Nouveau groupe sous `parent` (-1 : racine), déclaré avant ses enfants
+    int addGroup(string_view name, double weight, int parent) {
+        int g = groups.size();
+        groups.push_back({string(name), weight});
+        groupIds.emplace(string(name), g);
+        children.emplace_back();
+        children[parent + 1].push_back(~g);     // ~g : groupe, sinon file
+        built = false;
+        return g;
     }
 
-    ~ResourceAllocator() {
-        jsonFile << "    ]\n  }\n}\n";
-        logFile.close();
-        jsonFile.close();
+    int findGroup(string_view name) const {
+        auto it = groupIds.find(name);
+        return it == groupIds.end() ? -1 : it->second;
     }
 
-    void addQueue(Queue &q) { 
-        queues.push_back(q); 
+    // File suivante (indices dans l'ordre d'ajout) sous `group`
+    void addQueue(int group) {
+        children[group + 1].push_back(queueCount++);
+        built = false;
     }
 
-    void showInitialState() {
-        Display::clearScreen();
-        Display::printBanner();
-        Display::printHeader("🔧 CONFIGURATION INITIALE DU SYSTÈME");
-        
-        cout << "\n\033[1;37m📦 FILES D'ATTENTE CONFIGURÉES:\033[0m\n\n";
-        
-        double totalWeight = 0;
-        for(const auto& q : queues) totalWeight += q.weight;
-        
-        int fileNum = 1;
-        for(const auto& q : queues) {
-            double quota = (q.weight / totalWeight) * totalResource;
-            double percentage = (q.weight / totalWeight) * 100;
-            
-            cout << "  " << q.emoji << " \033[1;37mFile " << fileNum++ << ": " 
-                 << q.color << q.name << "\033[0m\n";
-            cout << "     ├─ Politique       : " << q.policy << "\n";
-            cout << "     ├─ Poids           : " << fixed << setprecision(3) << q.weight 
-                 << " (" << setprecision(1) << percentage << "%)\n";
-            cout << "     ├─ Quota théorique : " << setprecision(1) << quota << " unités\n";
-            cout << "     └─ Processus       : " << q.processes.size() << "\n";
-            
-            for(const auto& p : q.processes) {
-                cout << "         • " << p.name << " (demande: " 
-                     << setprecision(1) << p.demand << " unités)\n";
-            }
-            cout << "\n";
-        }
-
-        Display::printResourceGrid(totalResource, queues);
-        Display::printAllocationTable(queues);
+    bool empty() const { return groups.empty(); }
+    size_t groupCount() const { return groups.size(); }
+    size_t nodeCount() const { return 1 + groups.size() + queueCount; }
 
-        logFile << "═══ CONFIGURATION INITIALE ═══\n";
-        for(const auto& q : queues) {
-            logFile << q.name << " (" << q.policy << "): " 
-                   << q.processes.size() << " processus\n";
+    // Structure seule (groupes, enfants) : l'arbre aplati est reconstruit à la
+    // prochaine évaluation, qui recalcule tout
+    void save(SnapshotWriter &out) const {
+        out.put<uint64_t>(groups.size());
+        for(const auto &group : groups) {
+            out.put(group.name);
+            out.put(group.weight);
         }
-        logFile << "\n";
+        out.put(children);
+        out.put(queueCount);
     }
 
-    bool allProcessesFinished() {
-        for(const auto& q : queues) {
-            for(const auto& p : q.processes) {
-                if(!p.finished) return false;
-            }
+    bool load(SnapshotReader &in) {
+        uint64_t count;
+        if(!in.get(count) || count > (size_t)(in.end - in.p)) return false;
+        groups.assign(count, {});
+        groupIds.clear();
+        for(size_t g = 0; g < count; g++) {
+            if(!in.get(groups[g].name) || !in.get(groups[g].weight)) return false;
+            groupIds.emplace(groups[g].name, g);
         }
+        if(!in.get(children) || !in.get(queueCount) || children.size() != count + 1) return false;
+        built = false;
         return true;
     }
 
-    void simulate(double unit, int cycleDelay = 2000, bool autoMode = false) {
-        showInitialState();
-        
-        if(!autoMode) {
-            cout << "\n\n";
-            Display::printSeparator('═');
-            cout << "\033[1;33m⚡ Appuyez sur ENTRÉE pour démarrer la simulation...\033[0m\n";
-            Display::printSeparator('═');
-            cin.get();
-        } else {
-            cout << "\n\033[1;32m🚀 Mode automatique activé - démarrage dans 2 secondes...\033[0m\n";
-            this_thread::sleep_for(chrono::milliseconds(2000));
-        }
+    // Recalcul complet à la prochaine évaluation (référence des benchmarks)
+    void touchAll() {
+        fill(dirty.begin(), dirty.end(), 1);
+        if(!share.empty()) share[0] = -1.0;
+    }
 
-        // CYCLES D'ALLOCATION
-        while(!allProcessesFinished()) {
-            currentCycle++;
-            this_thread::sleep_for(chrono::milliseconds(cycleDelay));
-            runCycle(unit);
-            
-            if(!autoMode && currentCycle == 1) {
-                cout << "\n\n";
-                Display::printSeparator('═');
-                cout << "\033[1;33m⏭️  Appuyez sur ENTRÉE pour continuer...\033[0m\n";
-                Display::printSeparator('═');
-                cin.ignore();
-                cin.get();
-            }
-        }
+    // Quota de la file q à la dernière évaluation
+    double quota(size_t q) const {
+        return leafWeight[q] * leafDemand[q] * scale[groupOf[q]];
+    }
 
-        showFinalReport();
+    // Échelles des groupes pour weights[q], demands[q] et `total`
+    void evaluate(const double *weights, const double *demands, double total) {
+        if(!built) build();
+        for(int q = 0; q < queueCount; q++) refreshLeaf(q, weights[q], demands[q]);
+        propagate(total);
+    }
+
+    // Idem quand seules les files de `changed` ont pu changer depuis la
+    // dernière évaluation
+    void evaluate(const double *weights, const double *demands, double total, const vector<int> &changed) {
+        if(!built) {
+            evaluate(weights, demands, total);
+            return;
+        }
+        for(int q : changed) refreshLeaf(q, weights[q], demands[q]);
+        propagate(total);
     }
 
 private:
-    void runCycle(double unit) {
-        Display::clearScreen();
-        Display::printBanner();
-        Display::printHeader("🔄 CYCLE D'ALLOCATION", currentCycle);
+    struct Group {
+        string name;
+        double weight;
+    };
+    vector<Group> groups;
+    map<string, int, less<>> groupIds;
+    vector<vector<int>> children = vector<vector<int>>(1);  // par groupe + 1 (0 : racine)
+    int queueCount = 0;
+    bool built = false;
 
-        CycleStats stats;
-        stats.cycleNumber = currentCycle;
-        stats.activeProcesses = 0;
-        stats.totalAllocated = 0;
+    // Groupes en préordre, 0 : racine
+    vector<int> parent;
+    vector<int> subtreeEnd;
+    vector<int> leafBegin, leafEnd; // files du groupe dans `leaves`
+    vector<double> weight;
+    vector<double> demand;          // demande du sous-arbre
+    vector<double> weighted;        // somme poids × demande des enfants
+    vector<double> share;           // part de ressource
+    vector<double> scale;           // share / weighted
+    vector<char> dirty;             // sommes ou échelle à recalculer
 
-        logFile << "═══════════════════════════════════════\n";
-        logFile << "CYCLE " << currentCycle << "\n";
-        logFile << "═══════════════════════════════════════\n";
-        
-        if(currentCycle > 1) jsonFile << ",\n";
-        jsonFile << "      {\n        \"cycle\": " << currentCycle << ",\n";
-        jsonFile << "        \"allocations\": [\n";
+    // Files
+    vector<int> leaves;             // files rangées par groupe, en préordre
+    vector<int> groupOf;            // groupe (préordre) de chaque file
+    vector<double> leafWeight, leafDemand;
 
-        double totalWeight = 0;
-        for(auto &q : queues) {
-            double demandSum = 0;
-            for(auto &p : q.processes) {
-                if(!p.finished) demandSum += p.remaining;
+    void refreshLeaf(int q, double w, double d) {
+        if(d == leafDemand[q] && w == leafWeight[q]) return;
+        leafDemand[q] = d;
+        leafWeight[q] = w;
+        dirty[groupOf[q]] = 1;
+    }
+
+    void propagate(double total) {
+        int n = parent.size();
+        for(int g = n - 1; g >= 0; g--) {
+            if(!dirty[g]) continue;
+            double d = 0.0, s = 0.0;
+            for(int k = leafBegin[g]; k < leafEnd[g]; k++) {
+                int q = leaves[k];
+                d += leafDemand[q];
+                s += leafWeight[q] * leafDemand[q];
+            }
+            for(int c = g + 1; c < subtreeEnd[g]; c = subtreeEnd[c]) {
+                d += demand[c];
+                s += weight[c] * demand[c];
             }
-            totalWeight += q.weight * demandSum;
+            demand[g] = d;
+            weighted[g] = s;
+            if(g > 0) dirty[parent[g]] = 1;
         }
 
-        bool firstQueue = true;
-        for(auto &q : queues) {
-            double demandSum = 0;
-            for(auto &p : q.processes) {
-                if(!p.finished) demandSum += p.remaining;
+        if(share[0] != total) {
+            share[0] = total;
+            dirty[0] = 1;
+        }
+        for(int g = 0; g < n;) {
+            if(!dirty[g]) {
+                g = subtreeEnd[g];
+                continue;
             }
-            
-            double quota = totalWeight > 0 ? 
-                          (q.weight * demandSum / totalWeight) * totalResource : 0;
-            q.quota = quota;
-            
-            if(!firstQueue) jsonFile << ",\n";
-            jsonFile << "          {\n            \"queue\": \"" << q.name << "\",\n";
-            jsonFile << "            \"quota\": " << quota << ",\n";
-            jsonFile << "            \"processes\": [\n";
-            
-            allocateInQueue(q, quota, unit, stats);
-            
-            jsonFile << "            ]\n          }";
-            firstQueue = false;
+            dirty[g] = 0;
+            scale[g] = weighted[g] > 0 ? share[g] / weighted[g] : 0.0;
+            for(int c = g + 1; c < subtreeEnd[g]; c = subtreeEnd[c]) {
+                double x = weight[c] * demand[c] * scale[g];
+                if(x != share[c]) {
+                    share[c] = x;
+                    dirty[c] = 1;
+                }
+            }
+            g++;
         }
+    }
 
-        jsonFile << "\n        ]\n      }";
+    void build() {
+        size_t n = 1 + groups.size();
+        parent.clear();
+        subtreeEnd.assign(n, 0);
+        weight.clear();
+        leafBegin.clear();
+        leafEnd.clear();
+        leaves.clear();
+        groupOf.assign(queueCount, 0);
+        // Entrée dans un groupe (list : groupe déclaré + 1, 0 : racine) ou
+        // sortie (node : numéro de préordre, fin du sous-arbre)
+        struct Frame { int list; int up; int node; };
+        vector<Frame> stack = {{0, -1, -1}};
+        while(!stack.empty()) {
+            Frame frame = stack.back();
+            stack.pop_back();
+            if(frame.node >= 0) {
+                subtreeEnd[frame.node] = parent.size();
+                continue;
+            }
+            int g = parent.size();
+            parent.push_back(frame.up);
+            weight.push_back(frame.list == 0 ? 1.0 : groups[frame.list - 1].weight);
+            leafBegin.push_back(leaves.size());
+            for(int child : children[frame.list]) {
+                if(child < 0) continue;
+                groupOf[child] = g;
+                leaves.push_back(child);
+            }
+            leafEnd.push_back(leaves.size());
+            stack.push_back({frame.list, frame.up, g});
+            const vector<int> &list = children[frame.list];
+            for(auto it = list.rbegin(); it != list.rend(); ++it) {
+                if(*it < 0) stack.push_back({~*it + 1, g, -1});
+            }
+        }
+        demand.assign(n, 0.0);
+        weighted.assign(n, 0.0);
+        share.assign(n, -1.0);
+        scale.assign(n, 0.0);
+        dirty.assign(n, 1);
+        leafWeight.assign(queueCount, 0.0);
+        leafDemand.assign(queueCount, 0.0);
+        built = true;
+    }
+};
 
-        // Calcul utilisation
-        stats.utilization = (stats.totalAllocated / totalResource) * 100;
+// ==================== HISTORIQUE DES CYCLES ====================
+// Historique à mémoire bornée, en tableaux plats : par entrée, un CycleStats et
+// l'allocation de chaque file (l'indice de file sert d'identifiant, les noms
+// restent dans les files). Les `window` derniers cycles sont gardés tels quels ;
+// avec downsample > 1, les plus anciens sont regroupés par paquets de
+// `downsample` cycles dans un second anneau de `window` entrées, sinon oubliés.
+// window = 0 : tout est conservé.
+class CycleHistory {
+public:
+    void configure(size_t window, size_t downsample) {
+        factor = downsample;
+        recent = Ring();
+        coarse = Ring();
+        recent.capacity = coarse.capacity = window;
+        pendingCycles = 0;
+    }
 
-        Display::printCycleMetrics(currentCycle, stats, totalResource);
-        Display::printResourceGrid(totalResource, queues);
-        Display::printAllocationTable(queues);
-        Display::printDetailedProgress(queues, totalResource);
+    // Nouvelle file : ajoute une colonne (0 pour les cycles déjà enregistrés)
+    void addQueue() {
+        recent.addColumn(queueCount);
+        coarse.addColumn(queueCount);
+        pendingAllocated.push_back(0.0);
+        queueCount++;
+    }
 
-        history.push_back(stats);
-        logFile << "\n";
+    void push(const CycleStats &stats, const double *queueAllocated) {
+        recordedCycles++;
+        utilizationSum += stats.utilization;
+        if(recent.full()) {
+            if(factor > 1) fold(recent.oldest(), recent.oldestQueues(queueCount));
+            recent.dropOldest();
+        }
+        recent.push(stats, queueAllocated, queueCount);
+        last = stats;
     }
 
-    void allocateInQueue(Queue &q, double quota, double unit, CycleStats& stats) {
-        logFile << "\n[" << q.name << "] Policy: " << q.policy 
-               << " | Quota: " << fixed << setprecision(2) << quota << "\n";
+    bool empty() const { return recordedCycles == 0; }
+    const CycleStats &back() const { return last; }
 
-        bool firstProcess = true;
-        
-        if(q.policy == "RR") {
-            roundRobin(q, quota, unit, stats, firstProcess);
-        } else {
-            fifo(q, quota, unit, stats, firstProcess);
-        }
+    // Sur tous les cycles enregistrés, y compris ceux sortis de la fenêtre
+    long long cycles() const { return recordedCycles; }
+    double meanUtilization() const { return recordedCycles ? utilizationSum / recordedCycles : 0.0; }
+
+    // Entrées à pleine résolution, de la plus ancienne à la plus récente
+    size_t size() const { return recent.count; }
+    const CycleStats &at(size_t i) const { return recent.stats[recent.index(i)]; }
+    const double *queueAllocated(size_t i) const { return &recent.queues[recent.index(i) * queueCount]; }
+
+    // Paquets sous-échantillonnés, plus anciens que les entrées ci-dessus
+    size_t coarseSize() const { return coarse.count; }
+    const CycleStats &coarseAt(size_t i) const { return coarse.stats[coarse.index(i)]; }
+    const double *coarseQueueAllocated(size_t i) const { return &coarse.queues[coarse.index(i) * queueCount]; }
+
+    void save(SnapshotWriter &out) const {
+        recent.save(out);
+        coarse.save(out);
+        out.put(factor);
+        out.put(queueCount);
+        out.put(recordedCycles);
+        out.put(utilizationSum);
+        out.put(last);
+        out.put(pending);
+        out.put(pendingAllocated);
+        out.put(pendingCycles);
     }
 
-    void roundRobin(Queue &q, double quota, double unit, CycleStats& stats, bool& firstProcess) {
-        if(q.processes.empty()) return;
-        
-        int n = q.processes.size();
-        int consecutiveSkips = 0;
-        
-        while(quota > 0 && consecutiveSkips < n) {
-            Process &p = q.processes[q.rrIndex];
-            
-            if(!p.finished) {
-                // Aging
-                if(useAging && p.allocated == 0 && currentCycle > 1) {
-                    p.waitTime += 1.0;
-                    p.priority = max(1, (int)(p.basePriority * (1 + agingFactor * p.waitTime)));
-                }
-                
-                double alloc = min({p.remaining, unit, quota});
-                p.remaining -= alloc;
-                p.allocated += alloc;
-                quota -= alloc;
-                q.totalAllocated += alloc;
-                stats.totalAllocated += alloc;
-                stats.activeProcesses++;
-                
-                if(p.startCycle == -1) p.startCycle = currentCycle;
-                
-                logAllocation(q.name, p.name, alloc, firstProcess);
-                
-                if(p.remaining <= 0) {
-                    p.finished = true;
-                    p.endCycle = currentCycle;
-                    logFile << "    ✅ " << p.name << " TERMINÉ (durée: " 
-                           << (p.endCycle - p.startCycle + 1) << " cycles)\n";
-                }
-                consecutiveSkips = 0;
-            } else {
-                consecutiveSkips++;
+    bool load(SnapshotReader &in) {
+        return recent.load(in) && coarse.load(in) && in.get(factor) && in.get(queueCount) &&
+               in.get(recordedCycles) && in.get(utilizationSum) && in.get(last) && in.get(pending) &&
+               in.get(pendingAllocated) && in.get(pendingCycles);
+    }
+
+    size_t memoryBytes() const {
+        return (recent.stats.capacity() + coarse.stats.capacity()) * sizeof(CycleStats)
+             + (recent.queues.capacity() + coarse.queues.capacity() + pendingAllocated.capacity()) * sizeof(double);
+    }
+
+private:
+    // Anneau d'entrées ; capacity = 0 : croissance libre
+    struct Ring {
+        vector<CycleStats> stats;
+        vector<double> queues;      // count x queueCount, même indexation que stats
+        size_t start = 0;
+        size_t count = 0;
+        size_t capacity = 0;
+
+        bool full() const { return capacity > 0 && count == capacity; }
+        size_t index(size_t i) const { return capacity > 0 ? (start + i) % capacity : i; }
+        const CycleStats &oldest() const { return stats[start]; }
+        const double *oldestQueues(size_t width) const { return &queues[start * width]; }
+
+        void push(const CycleStats &entry, const double *allocated, size_t width) {
+            if(capacity == 0 || stats.size() < capacity) {
+                stats.push_back(entry);
+                queues.insert(queues.end(), allocated, allocated + width);
+                count++;
+                return;
             }
-            
-            q.rrIndex = (q.rrIndex + 1) % n;
+            size_t slot = (start + count) % capacity;
+            stats[slot] = entry;
+            copy(allocated, allocated + width, queues.begin() + slot * width);
+            count++;
         }
-    }
 
-    void fifo(Queue &q, double quota, double unit, CycleStats& stats, bool& firstProcess) {
-        for(auto &p : q.processes) {
-            if(quota <= 0) break;
-            if(!p.finished) {
-                double alloc = min({p.remaining, unit, quota});
-                p.remaining -= alloc;
-                p.allocated += alloc;
-                quota -= alloc;
-                q.totalAllocated += alloc;
-                stats.totalAllocated += alloc;
-                stats.activeProcesses++;
-                
-                if(p.startCycle == -1) p.startCycle = currentCycle;
-                
-                logAllocation(q.name, p.name, alloc, firstProcess);
-                
-                if(p.remaining <= 0) {
-                    p.finished = true;
-                    p.endCycle = currentCycle;
-                    logFile << "    ✅ " << p.name << " TERMINÉ (durée: " 
-                           << (p.endCycle - p.startCycle + 1) << " cycles)\n";
-                }
+        void dropOldest() {
+            start = (start + 1) % capacity;
+            count--;
+        }
+
+        void save(SnapshotWriter &out) const {
+            out.put(stats);
+            out.put(queues);
+            out.put(start);
+            out.put(count);
+            out.put(capacity);
+        }
+
+        bool load(SnapshotReader &in) {
+            return in.get(stats) && in.get(queues) && in.get(start) && in.get(count) && in.get(capacity);
+        }
+
+        void addColumn(size_t width) {
+            vector<double> widened;
+            widened.reserve(stats.size() * (width + 1));
+            for(size_t row = 0; row < stats.size(); row++) {
+                widened.insert(widened.end(), queues.begin() + row * width, queues.begin() + (row + 1) * width);
+                widened.push_back(0.0);
             }
+            queues.swap(widened);
+        }
+    };
+
+    Ring recent;
+    Ring coarse;
+    size_t factor = 0;
+    size_t queueCount = 0;
+    long long recordedCycles = 0;
+    double utilizationSum = 0.0;
+    CycleStats last = {};
+
+    // Paquet en cours de sous-échantillonnage
+    CycleStats pending = {};
+    vector<double> pendingAllocated;
+    size_t pendingCycles = 0;
+
+    void fold(const CycleStats &entry, const double *allocated) {
+        if(pendingCycles == 0) {
+            pending = entry;
+            pending.utilization = 0.0;
+            pending.activeProcesses = pending.finishedProcesses = 0;
+            pending.totalAllocated = 0.0;
+            pending.cycleSpan = 0;
+            fill(pendingAllocated.begin(), pendingAllocated.end(), 0.0);
+        }
+        pending.activeProcesses += entry.activeProcesses;
+        pending.finishedProcesses += entry.finishedProcesses;
+        pending.totalAllocated += entry.totalAllocated;
+        pending.utilization += entry.utilization;
+        pending.cycleSpan += entry.cycleSpan;
+        for(size_t qi = 0; qi < queueCount; qi++) pendingAllocated[qi] += allocated[qi];
+
+        if(++pendingCycles == factor) {
+            pending.utilization /= pendingCycles;
+            if(coarse.full()) coarse.dropOldest();
+            coarse.push(pending, pendingAllocated.data(), queueCount);
+            pendingCycles = 0;
         }
     }
+};
 
-    void logAllocation(const string &queue, const string &process, double alloc, bool& firstProcess) {
-        logFile << "  ➜ " << process << " reçoit " << fixed << setprecision(2) 
-                << alloc << " unités\n";
-        
-        if(!firstProcess) jsonFile << ",\n";
-        jsonFile << "              {\"process\": \"" << process 
-                 << "\", \"allocated\": " << alloc << "}";
-        firstProcess = false;
+// ==================== INSTRUMENTATION ====================
+// Minuteurs à portée autour des phases de runCycle et de simulate, agrégés par
+// phase en histogrammes logarithmiques : chaque puissance de deux (en ns) est
+// coupée en 8 seaux égaux, soit des quantiles à 12,5 % près.
+// Compilés seulement avec -DSIM4_PROFILE : sinon PHASE_TIMER ne produit aucune
+// instruction et l'allocateur n'a pas de profileur.
+enum class Phase : uint8_t {
+    Cycle, Admission, Quotas, Allocation, Records, Logs, History,
+    Render, RenderTable, RenderProgress, Count
+};
+
+#if defined(SIM4_PROFILE)
+class PhaseHistogram {
+public:
+    static constexpr int SubBuckets = 8;
+    static constexpr int Buckets = 46 * SubBuckets;    // au-delà de 2^48 ns (~78 h) : dernier seau
+
+    static int bucketOf(uint64_t ns) {
+        if(ns < SubBuckets) return ns;
+        int octave = bit_width(ns) - 1;                 // >= 3
+        int sub = (ns >> (octave - 3)) & (SubBuckets - 1);
+        return min(Buckets - 1, (octave - 2) * SubBuckets + sub);
     }
 
-    void showFinalReport() {
-        Display::clearScreen();
-        Display::printBanner();
-        Display::printHeader("🏆 RAPPORT FINAL DE SIMULATION");
+    // Plus petite durée du seau b
+    static uint64_t bucketLow(int b) {
+        if(b < SubBuckets) return b;
+        int octave = b / SubBuckets + 2;
+        return uint64_t(SubBuckets + b % SubBuckets) << (octave - 3);
+    }
 
-        cout << "\n\033[1;32m✅ Simulation terminée avec succès!\033[0m\n";
-        cout << "   📊 Cycles totaux: \033[1;33m" << currentCycle << "\033[0m\n\n";
+    void record(uint64_t ns) {
+        counts[bucketOf(ns)]++;
+        samples++;
+        total += ns;
+        lowest = min(lowest, ns);
+        highest = max(highest, ns);
+    }
 
-        Display::printSeparator('═');
-        cout << "\n\033[1;36m📈 STATISTIQUES GLOBALES PAR FILE\033[0m\n\n";
+    uint64_t count() const { return samples; }
+    uint64_t totalNs() const { return total; }
+    uint64_t minNs() const { return samples ? lowest : 0; }
+    uint64_t maxNs() const { return highest; }
+    double meanNs() const { return samples ? (double)total / samples : 0.0; }
+    const array<uint64_t, Buckets> &bucketCounts() const { return counts; }
 
-        for(const auto& q : queues) {
-            cout << "  " << q.emoji << " " << q.color << q.name << "\033[0m\n";
-            cout << "     ├─ Ressources allouées : " << fixed << setprecision(2) 
-                 << q.totalAllocated << " unités\n";
-            
-            int completedCount = 0;
-            double avgDuration = 0;
-            for(const auto& p : q.processes) {
-                if(p.finished) {
-                    completedCount++;
-                    avgDuration += (p.endCycle - p.startCycle + 1);
-                }
-            }
-            avgDuration /= max(1, completedCount);
-            
-            cout << "     ├─ Processus terminés  : " << completedCount << "/" 
-                 << q.processes.size() << "\n";
-            cout << "     └─ Durée moyenne       : " << fixed << setprecision(1) 
-                 << avgDuration << " cycles\n\n";
+    // Quantile approché par la borne haute du seau qui l'atteint
+    uint64_t quantileNs(double q) const {
+        if(samples == 0) return 0;
+        uint64_t rank = max<uint64_t>(1, (uint64_t)ceil(q * samples));
+        uint64_t seen = 0;
+        for(int b = 0; b < Buckets; b++) {
+            seen += counts[b];
+            if(seen >= rank) return b + 1 < Buckets ? min(highest, bucketLow(b + 1) - 1) : highest;
         }
+        return highest;
+    }
 
-        Display::printSeparator('═');
-        cout << "\n\033[1;35m🔍 DÉTAILS PAR PROCESSUS\033[0m\n\n";
+private:
+    array<uint64_t, Buckets> counts{};
+    uint64_t samples = 0;
+    uint64_t total = 0;
+    uint64_t lowest = numeric_limits<uint64_t>::max();
+    uint64_t highest = 0;
+};
 
-        for(const auto& q : queues) {
-            cout << "  " << q.color << "▸ " << q.name << "\033[0m\n";
-            for(const auto& p : q.processes) {
-                cout << "    • " << setw(12) << left << p.name 
-                     << " │ Demande: " << setw(6) << right << fixed << setprecision(1) << p.demand 
-                     << " │ Alloué: " << setw(6) << p.allocated 
-                     << " │ Début: C" << setw(2) << p.startCycle 
-                     << " │ Fin: C" << setw(2) << p.endCycle 
-                     << " │ Durée: " << (p.endCycle - p.startCycle + 1) << " cycles\n";
+class PhaseProfiler {
+public:
+    static const char *name(Phase phase) {
+        static const char *names[] = {"cycle", "admission", "quotas", "allocation", "records", "logs",
+                                      "history", "render", "render.table", "render.progress"};
+        return names[(size_t)phase];
+    }
+
+    void record(Phase phase, uint64_t ns) { phases[(size_t)phase].record(ns); }
+    const PhaseHistogram &histogram(Phase phase) const { return phases[(size_t)phase]; }
+
+    // Écritures directes faites à l'intérieur d'une autre phase (WRITE_TIMER),
+    // cumulées jusqu'à la fin de celle-ci (PHASE_TIMER_SPLIT)
+    void addNested(uint64_t ns) { nestedNs += ns; }
+    uint64_t takeNested() {
+        uint64_t ns = nestedNs;
+        nestedNs = 0;
+        return ns;
+    }
+
+    // Tableau du rapport final ; part : temps de la phase / temps mesuré
+    // (cycles du moteur et rendu, qui les englobent toutes)
+    void report(ostream &out) const {
+        double measuredNs = max<uint64_t>(1, histogram(Phase::Cycle).totalNs() + histogram(Phase::Render).totalNs());
+        out << "  " << left << setw(16) << "Phase" << right << setw(10) << "Appels" << setw(12) << "Moy. µs"
+            << setw(12) << "p50 µs" << setw(12) << "p99 µs" << setw(12) << "Max µs" << setw(9) << "Part" << "\n";
+        for(size_t k = 0; k < phases.size(); k++) {
+            const PhaseHistogram &h = phases[k];
+            if(h.count() == 0) continue;
+            out << "  " << left << setw(16) << name((Phase)k) << right << setw(10) << h.count()
+                << fixed << setprecision(2) << setw(12) << h.meanNs() / 1e3
+                << setw(12) << h.quantileNs(0.50) / 1e3 << setw(12) << h.quantileNs(0.99) / 1e3
+                << setw(12) << h.maxNs() / 1e3 << setprecision(1) << setw(8) << 100.0 * h.totalNs() / measuredNs
+                << "%\n";
+        }
+        out.unsetf(ios::floatfield);
+        out << setprecision(6);
+    }
+
+    // Une ligne clé=valeur par phase mesurée ; buckets : seaux non vides, sous
+    // la forme borne_basse_ns:nombre
+    bool write(const string &path) const {
+        ofstream out(path);
+        for(size_t k = 0; k < phases.size(); k++) {
+            const PhaseHistogram &h = phases[k];
+            if(h.count() == 0) continue;
+            out << "phase=" << name((Phase)k) << " count=" << h.count() << " total_ns=" << h.totalNs()
+                << " mean_ns=" << (uint64_t)h.meanNs() << " min_ns=" << h.minNs()
+                << " p50_ns=" << h.quantileNs(0.50) << " p90_ns=" << h.quantileNs(0.90)
+                << " p99_ns=" << h.quantileNs(0.99) << " p999_ns=" << h.quantileNs(0.999)
+                << " max_ns=" << h.maxNs() << " buckets=";
+            bool first = true;
+            for(int b = 0; b < PhaseHistogram::Buckets; b++) {
+                if(h.bucketCounts()[b] == 0) continue;
+                out << (first ? "" : ",") << PhaseHistogram::bucketLow(b) << ":" << h.bucketCounts()[b];
+                first = false;
             }
-            cout << "\n";
+            out << "\n";
         }
+        return bool(out);
+    }
 
-        Display::printSeparator('═');
-        cout << "\n\033[1;33m💾 FICHIERS GÉNÉRÉS\033[0m\n";
-        cout << "  ✓ allocation_log.txt  (journal détaillé)\n";
-        cout << "  ✓ allocation_data.json (données structurées)\n\n";
+private:
+    array<PhaseHistogram, (size_t)Phase::Count> phases;
+    uint64_t nestedNs = 0;
+};
 
-        logFile << "\n═══════════════════════════════════════\n";
-        logFile << "RESULTAT FINAL\n";
-        logFile << "═══════════════════════════════════════\n";
-        logFile << "Cycles totaux: " << currentCycle << "\n";
-        logFile << "Tous les processus terminés avec succès.\n";
+class PhaseTimer {
+public:
+    PhaseTimer(PhaseProfiler &target, Phase timed)
+        : profiler(target), phase(timed), start(chrono::steady_clock::now()) {}
+    ~PhaseTimer() {
+        profiler.record(phase, chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count());
     }
+    PhaseTimer(const PhaseTimer &) = delete;
+    PhaseTimer &operator=(const PhaseTimer &) = delete;
+
+private:
+    PhaseProfiler &profiler;
+    Phase phase;
+    chrono::steady_clock::time_point start;
 };
 
-// ==================== MAIN ====================
-int main() {
-    Display::clearScreen();
-    Display::printBanner();
-    
-    cout << "\n\033[1;37m🔧 Configuration du système...\033[0m\n\n";
+// Phase dont une partie (les écritures chronométrées par WRITE_TIMER) est
+// comptée dans une autre : une mesure pour chacune, sans recouvrement
+class SplitPhaseTimer {
+public:
+    SplitPhaseTimer(PhaseProfiler &target, Phase timed, Phase nested)
+        : profiler(target), phase(timed), split(nested), start(chrono::steady_clock::now()) {
+        profiler.takeNested();
+    }
+    ~SplitPhaseTimer() {
+        uint64_t total = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+        uint64_t nested = min(total, profiler.takeNested());
+        profiler.record(phase, total - nested);
+        if(nested > 0) profiler.record(split, nested);
+    }
+    SplitPhaseTimer(const SplitPhaseTimer &) = delete;
+    SplitPhaseTimer &operator=(const SplitPhaseTimer &) = delete;
+
+private:
+    PhaseProfiler &profiler;
+    Phase phase;
+    Phase split;
+    chrono::steady_clock::time_point start;
+};
 
-    ResourceAllocator allocator(100.0);
+// Une écriture directe (thread du moteur seulement) ; inactif si enabled est faux
+class WriteTimer {
+public:
+    WriteTimer(PhaseProfiler &target, bool enabled) : profiler(enabled ? &target : nullptr) {
+        if(profiler) start = chrono::steady_clock::now();
+    }
+    ~WriteTimer() {
+        if(profiler) {
+            profiler->addNested(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count());
+        }
+    }
+    WriteTimer(const WriteTimer &) = delete;
+    WriteTimer &operator=(const WriteTimer &) = delete;
 
-    // Configuration des files avec couleurs et emojis
-    Queue q1 = {
-        "File 1 (VVIP)", 
+private:
+    PhaseProfiler *profiler;
+    chrono::steady_clock::time_point start;
+};
+
+#define PHASE_TIMER_JOIN(a, b) a##b
+#define PHASE_TIMER_NAME(line) PHASE_TIMER_JOIN(phaseTimer, line)
+#define PHASE_TIMER(profiler, phase) PhaseTimer PHASE_TIMER_NAME(__LINE__)(profiler, phase)
+#define PHASE_TIMER_SPLIT(profiler, phase, nested) \
+    SplitPhaseTimer PHASE_TIMER_NAME(__LINE__)(profiler, phase, nested)
+#define WRITE_TIMER(profiler, enabled) WriteTimer PHASE_TIMER_NAME(__LINE__)(profiler, enabled)
+#else
+#define PHASE_TIMER(profiler, phase) ((void)0)
+#define PHASE_TIMER_SPLIT(profiler, phase, nested) ((void)0)
+#define WRITE_TIMER(profiler, enabled) ((void)0)
+#endif
+
+// ==================== POOL DE THREADS ====================
+// Workers persistants réveillés à chaque appel : un cycle distribue ses files
+// sans créer de threads. Le thread appelant participe au travail.
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned threads) {
+        for(unsigned t = 1; t < max(1u, threads); t++) {
+            workers.emplace_back([this] { workerLoop(); });
+        }
+    }
+
+    ~ThreadPool() {
         {
-            {"P1", 50, 50, 1, false, 0.0, -1, -1, 0.0, 1}, 
-            {"P2", 30, 30, 1, false, 0.0, -1, -1, 0.0, 1}
-        }, 
-        0.5, 
-        "RR",
-        0,
-        0.0,
-        0.0,
-        "\033[1;31m",  // Rouge
-        "🔴"
-    };
+            lock_guard<mutex> lock(m);
+            stopping = true;
+        }
+        wake.notify_all();
+        for(auto &w : workers) w.join();
+    }
 
-    Queue q2 = {
-        "File 2 (VIP)", 
+    unsigned size() const { return workers.size() + 1; }
+
+    // task(begin, end) sur [0, n) découpé en blocs de `grain`, pris à la volée
+    // par les threads ; retourne quand tous les blocs sont traités.
+    void parallelFor(size_t n, size_t grain, const function<void(size_t, size_t)> &task) {
         {
-            {"P3", 60, 60, 2, false, 0.0, -1, -1, 0.0, 2}, 
-            {"P4", 40, 40, 2, false, 0.0, -1, -1, 0.0, 2}
-        }, 
-        0.3, 
-        "RR",
-        0,
-        0.0,
-        0.0,
+            lock_guard<mutex> lock(m);
+            current = &task;
+            total = n;
+            chunk = max<size_t>(1, grain);
+            next = 0;
+            busy = workers.size();
+            generation++;
+        }
+        wake.notify_all();
+        runChunks(task);
+
+        unique_lock<mutex> lock(m);
+        done.wait(lock, [this] { return busy == 0; });
+        current = nullptr;
+    }
+
+private:
+    vector<thread> workers;
+    mutex m;
+    condition_variable wake;
+    condition_variable done;
+    const function<void(size_t, size_t)> *current = nullptr;
+    size_t total = 0;
+    size_t chunk = 1;
+    atomic<size_t> next{0};
+    unsigned generation = 0;
+    unsigned busy = 0;
+    bool stopping = false;
+
+    void runChunks(const function<void(size_t, size_t)> &task) {
+        while(true) {
+            size_t begin = next.fetch_add(chunk, memory_order_relaxed);
+            if(begin >= total) break;
+            task(begin, min(total, begin + chunk));
+        }
+    }
+
+    void workerLoop() {
+        unsigned seen = 0;
+        while(true) {
+            const function<void(size_t, size_t)> *task;
+            {
+                unique_lock<mutex> lock(m);
+                wake.wait(lock, [&] { return stopping || generation != seen; });
+                if(stopping) return;
+                seen = generation;
+                task = current;
+            }
+            runChunks(*task);
+            {
+                lock_guard<mutex> lock(m);
+                if(--busy == 0) done.notify_one();
+            }
+        }
+    }
+};
+
+// ==================== CLASSE UTILITAIRE ====================
+class Display {
+public:
+    static void clearScreen() {
+        #ifdef _WIN32
+            system("cls");
+        #else
+            system("clear");
+        #endif
+    }
+
+    static void printBanner(ostream &out) {
+        out << "\033[1;36m"; // Cyan bold
+        out << "\n╔═══════════════════════════════════════════════════════════════════════╗\n";
+        out << "║                                                                       ║\n";
+        out << "║          🚀        SIMULATEUR CAP-PRO-RATA                🚀          ║\n";
+        out << "║                                                                       ║\n";
+        out << "║              Allocation Multi-Niveaux de Ressources                   ║\n";
+        out << "║                  Akamba Biyembe aka Artemis                           ║\n";
+        out << "║                                                                       ║\n";
+        out << "╚═══════════════════════════════════════════════════════════════════════╝\n";
+        out << "\033[0m"; // Reset
+    }
+
+    static void printHeader(ostream &out, const string& title, int cycle = -1) {
+        out << "\n\033[1;34m"; // Blue bold
+        out << "╔═══════════════════════════════════════════════════════════════════════╗\n";
+        if(cycle >= 0) {
+            out << "║  " << title << " " << cycle << string(58 - title.length() - to_string(cycle).length(), ' ') << "║\n";
+        } else {
+            out << "║  " << title << string(68 - title.length(), ' ') << "║\n";
+        }
+        out << "╚═══════════════════════════════════════════════════════════════════════╝\n";
+        out << "\033[0m";
+    }
+
+    static void printSeparator(ostream &out, const char *style = "─") {
+        out << "\033[0;90m"; // Dark gray
+        for(int i = 0; i < 75; i++) out << style;
+        out << "\033[0m\n";
+    }
+
+    static string getStatusEmoji(bool finished) {
+        return finished ? "\033[1;32m✅\033[0m" : "\033[1;33m⏳\033[0m";
+    }
+
+    static string getProgressBar(double current, double total, int width = 20) {
+        int filled = (int)((current / total) * width);
+        string bar = "\033[1;32m[\033[0m";
+        for(int i = 0; i < width; i++) {
+            if(i < filled) bar += "\033[1;32m█\033[0m";
+            else bar += "\033[0;90m░\033[0m";
+        }
+        bar += "\033[1;32m]\033[0m";
+        return bar;
+    }
+
+    static void printResourceGrid(ostream &out, double totalResource, const vector<Queue>& queues, int gridWidth = 60) {
+        out << "\n\033[1;35m📊 DISTRIBUTION DES RESSOURCES\033[0m\n";
+        out << "   Total disponible: \033[1;33m" << fixed << setprecision(1) 
+            << totalResource << " unités\033[0m\n\n";
+        
+        double totalWeight = 0;
+        for(const auto& q : queues) totalWeight += q.weight;
+        
+        out << "   ┌";
+        for(int i = 0; i < gridWidth; i++) out << "─";
+        out << "┐\n   │";
+
+        for(const auto& q : queues) {
+            int cells = (int)((q.weight / totalWeight) * gridWidth);
+            string colorCode = q.color;
+            
+            for(int i = 0; i < cells; i++) {
+                if(i == cells/2) out << q.emoji;
+                else out << colorCode << "█\033[0m";
+            }
+        }
+        
+        out << "│\n   └";
+        for(int i = 0; i < gridWidth; i++) out << "─";
+        out << "┘\n\n";
+
+        // Légende améliorée
+        out << "   \033[1;37mLÉGENDE:\033[0m\n";
+        for(const auto& q : queues) {
+            double quota = (q.weight / totalWeight) * totalResource;
+            double percentage = (q.weight / totalWeight) * 100;
+            out << "   " << q.emoji << " " << q.color << q.name << "\033[0m"
+                << " │ Poids: " << fixed << setprecision(2) << q.weight
+                << " │ Quota: " << setprecision(1) << quota << " unités"
+                << " │ Part: " << setprecision(1) << percentage << "%\n";
+        }
+    }
+
+    static void printAllocationTable(ostream &out, const vector<Queue>& queues) {
+        out << "\n\033[1;36m📋 TABLEAU D'ALLOCATION DÉTAILLÉ\033[0m\n\n";
+        
+        for(const auto& q : queues) {
+            out << "  " << q.emoji << " " << q.color << "━━━ " << q.name 
+                << " [" << q.policy << "] ━━━\033[0m\n";
+            out << "  ┌────────────┬──────────┬──────────┬──────────┬──────────┬────────┐\n";
+            out << "  │ Processus  │ Demande  │ Restant  │  Alloué  │ Progress │  État  │\n";
+            out << "  ├────────────┼──────────┼──────────┼──────────┼──────────┼────────┤\n";
+            
+            for(const auto& p : q.processes) {
+                out << "  │ " << setw(10) << left << p.name 
+                    << " │ " << setw(8) << right << fixed << setprecision(1) << p.demand
+                    << " │ " << setw(8) << p.remaining
+                    << " │ " << setw(8) << p.allocated
+                    << " │ " << getProgressBar(p.allocated, p.demand, 8)
+                    << " │ " << getStatusEmoji(p.finished) << "   │\n";
+            }
+            out << "  └────────────┴──────────┴──────────┴──────────┴──────────┴────────┘\n";
+            
+            // Statistiques de la file
+            int completed = 0, total = q.processes.size();
+            double totalDemand = 0, totalAllocated = 0;
+            for(const auto& p : q.processes) {
+                if(p.finished) completed++;
+                totalDemand += p.demand;
+                totalAllocated += p.allocated;
+            }
+            
+            out << "  📊 Stats: " << completed << "/" << total << " terminés"
+                << " │ Total alloué: " << fixed << setprecision(1) << totalAllocated 
+                << "/" << totalDemand << " unités\n\n";
+        }
+    }
+
+    static void printDetailedProgress(ostream &out, const vector<Queue>& queues, double totalResource) {
+        out << "\n\033[1;33m🎯 PROGRESSION DÉTAILLÉE PAR PROCESSUS\033[0m\n\n";
+        
+        for(const auto& q : queues) {
+            out << "  " << q.emoji << " " << q.color << q.name << "\033[0m\n";
+            
+            for(const auto& p : q.processes) {
+                double progress = (p.allocated / p.demand) * 100;
+                out << "    ├─ " << setw(12) << left << p.name << " ";
+                
+                // Barre de progression colorée
+                int barWidth = 30;
+                int filled = (int)((progress / 100.0) * barWidth);
+                out << "[";
+                for(int i = 0; i < barWidth; i++) {
+                    if(i < filled) {
+                        if(progress >= 100) out << "\033[1;32m█\033[0m";
+                        else if(progress >= 66) out << "\033[1;33m█\033[0m";
+                        else if(progress >= 33) out << "\033[1;36m█\033[0m";
+                        else out << "\033[1;31m█\033[0m";
+                    } else {
+                        out << "\033[0;90m░\033[0m";
+                    }
+                }
+                out << "] " << fixed << setprecision(1) << progress << "%";
+                
+                if(p.finished) {
+                    out << " \033[1;32m✓ COMPLÉTÉ\033[0m";
+                }
+                out << "\n";
+            }
+            out << "\n";
+        }
+    }
+
+    static void printCycleMetrics(ostream &out, int cycle, const CycleStats& stats, double totalResource) {
+        out << "\n\033[1;35m📈 MÉTRIQUES DU CYCLE " << cycle << "\033[0m\n";
+        out << "  ┌─────────────────────────────────────────────┐\n";
+        out << "  │ Processus actifs    : " << setw(18) << right << stats.activeProcesses << "  │\n";
+        out << "  │ Ressources allouées : " << setw(15) << fixed << setprecision(2) 
+            << stats.totalAllocated << " unités │\n";
+        out << "  │ Taux d'utilisation  : " << setw(17) << setprecision(1) 
+            << stats.utilization << "% │\n";
+        out << "  └─────────────────────────────────────────────┘\n";
+    }
+
+    static void printWaitingAnimation(int duration_ms) {
+        const string anim[] = {"⠋", "⠙", "⠹", "⠸", "⠼", "⠴", "⠦", "⠧", "⠇", "⠏"};
+        int steps = duration_ms / 100;
+        
+        for(int i = 0; i < steps; i++) {
+            cout << "\r  " << anim[i % 10] << " Allocation en cours..." << flush;
+            this_thread::sleep_for(chrono::milliseconds(100));
+        }
+        cout << "\r  ✓ Allocation terminée!            \n";
+    }
+};
+
+// ==================== RENDU PAR TRAMES ====================
+// Chaque trame est composée dans un tampon préalloué, puis comparée ligne à
+// ligne à la trame affichée : seules les lignes modifiées sont réécrites, par
+// adressage du curseur, et le tout part en une seule écriture. Ni effacement
+// de l'écran ni processus externe entre deux trames, donc pas de scintillement.
+// Le débit est plafonné (due()) indépendamment du rythme de la simulation.
+// Hypothèse : une ligne de trame tient sur une ligne du terminal (la mise en
+// page de Display fait moins de 80 colonnes) ; les lignes au-delà de la
+// hauteur du terminal ne sont pas affichées.
+class FrameBuffer : public streambuf {
+public:
+    explicit FrameBuffer(size_t capacity) : text(capacity) { clear(); }
+
+    void clear() { setp(text.data(), text.data() + text.size()); }
+    string_view view() const { return {pbase(), size_t(pptr() - pbase())}; }
+
+protected:
+    // Tampon plein : il double, le contenu écrit est conservé
+    int_type overflow(int_type ch) override {
+        size_t used = pptr() - pbase();
+        text.resize(text.size() * 2);
+        setp(text.data(), text.data() + text.size());
+        pbump((int)used);
+        if(!traits_type::eq_int_type(ch, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(ch);
+            pbump(1);
+        }
+        return traits_type::not_eof(ch);
+    }
+
+private:
+    vector<char> text;
+};
+
+class FrameRenderer {
+public:
+    explicit FrameRenderer(double framesPerSecond = 30.0) : buffer(1 << 16), frame(&buffer) {
+        setFrameRate(framesPerSecond);
+        shown.reserve(1 << 16);
+        output.reserve(1 << 16);
+    }
+
+    void setFrameRate(double framesPerSecond) {
+        interval = chrono::nanoseconds(framesPerSecond > 0 ? (long long)(1e9 / framesPerSecond) : 0);
+    }
+
+    // Vrai si le plafond autorise une nouvelle trame
+    bool due() const { return chrono::steady_clock::now() - lastFrame >= interval; }
+
+    // Flux de composition de la trame suivante (vide)
+    ostream &beginFrame() {
+        buffer.clear();
+        frame.clear();
+        return frame;
+    }
+
+    // L'écran a été modifié hors du rendu : la prochaine trame le redessine en entier
+    void invalidate() { shown.clear(); shownLines.clear(); fullRedraw = true; }
+
+    // Affiche la trame composée : lignes changées seulement, en une écriture
+    void present() {
+        string_view next = buffer.view();
+        splitLines(next, nextLines);
+        size_t rows = terminalRows();
+        if(rows != lastRows) fullRedraw = true;
+        lastRows = rows;
+        size_t visible = min(nextLines.size(), rows > 1 ? rows - 1 : nextLines.size());
+
+        output.clear();
+        output += "\033[?25l";
+        if(fullRedraw) output += "\033[H\033[2J";
+        for(size_t r = 0; r < visible; r++) {
+            string_view line = next.substr(nextLines[r].first, nextLines[r].second);
+            if(!fullRedraw && r < shownLines.size()
+               && string_view(shown).substr(shownLines[r].first, shownLines[r].second) == line) continue;
+            moveTo(r);
+            output.append(line);
+            output += "\033[K";
+        }
+        // Lignes en trop de la trame précédente, puis curseur sous la trame
+        moveTo(visible);
+        if(visible < shownVisible) output += "\033[J";
+        output += "\033[?25h";
+        writeOut();
+
+        shown.assign(next);
+        shownLines.swap(nextLines);
+        shownVisible = visible;
+        fullRedraw = false;
+        lastFrame = chrono::steady_clock::now();
+        frames++;
+    }
+
+    size_t frameCount() const { return frames; }
+
+private:
+    FrameBuffer buffer;
+    ostream frame;
+    string shown;                               // trame à l'écran
+    vector<pair<size_t, size_t>> shownLines;    // (début, longueur) de chaque ligne
+    vector<pair<size_t, size_t>> nextLines;
+    string output;
+    size_t shownVisible = 0;
+    size_t lastRows = 0;
+    bool fullRedraw = true;
+    chrono::nanoseconds interval{0};
+    chrono::steady_clock::time_point lastFrame{};
+    size_t frames = 0;
+
+    static void splitLines(string_view text, vector<pair<size_t, size_t>> &lines) {
+        lines.clear();
+        size_t start = 0;
+        while(start < text.size()) {
+            size_t end = text.find('\n', start);
+            if(end == string_view::npos) end = text.size();
+            lines.push_back({start, end - start});
+            start = end + 1;
+        }
+    }
+
+    void moveTo(size_t row) {
+        char sequence[32];
+        int n = snprintf(sequence, sizeof(sequence), "\033[%zu;1H", row + 1);
+        output.append(sequence, n);
+    }
+
+    // Hauteur du terminal ; illimitée si la sortie n'en est pas un
+    static size_t terminalRows() {
+#if defined(__unix__) || defined(__APPLE__)
+        winsize size{};
+        if(ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0 && size.ws_row > 0) return size.ws_row;
+#endif
+        return numeric_limits<size_t>::max();
+    }
+
+    void writeOut() {
+        cout.flush();
+#if defined(__unix__) || defined(__APPLE__)
+        size_t sent = 0;
+        while(sent < output.size()) {
+            ssize_t n = write(STDOUT_FILENO, output.data() + sent, output.size() - sent);
+            if(n < 0 && errno == EINTR) continue;
+            if(n <= 0) break;
+            sent += n;
+        }
+#else
+        cout.write(output.data(), output.size());
+        cout.flush();
+#endif
+    }
+};
+
+// ==================== FORMAT DU JOURNAL ====================
+// Lignes de allocation_log.txt, écrites directement ou par le journal asynchrone
+class LogLayout {
+public:
+    static void cycleHeader(ostream &log, int cycle) {
+        log << "═══════════════════════════════════════\n";
+        log << "CYCLE " << cycle << "\n";
+        log << "═══════════════════════════════════════\n";
+    }
+
+    static void cycleEnd(ostream &log) {
+        log << "\n";
+    }
+
+    static void queueHeader(ostream &log, const string &queue, const string &policy, double quota) {
+        log << "\n[" << queue << "] Policy: " << policy 
+            << " | Quota: " << fixed << setprecision(2) << quota << "\n";
+    }
+
+    static void allocation(ostream &log, const string &process, double alloc) {
+        log << "  ➜ " << process << " reçoit " << fixed << setprecision(2) 
+            << alloc << " unités\n";
+    }
+
+    static void finished(ostream &log, const string &process, int duration) {
+        log << "    ✅ " << process << " TERMINÉ (durée: " 
+            << duration << " cycles)\n";
+    }
+};
+
+// ==================== FORMAT JSON ====================
+// Mise en page de allocation_data.json, partagée par le moteur et par le
+// convertisseur de trace binaire : les deux produisent le même fichier.
+class JsonLayout {
+public:
+    static void header(ostream &json, double totalResource, const string &timestamp) {
+        json << "{\n  \"simulation\": {\n";
+        json << "    \"totalResource\": " << totalResource << ",\n";
+        json << "    \"timestamp\": \"" << timestamp << "\",\n";
+        json << "    \"cycles\": [\n";
+    }
+
+    static void footer(ostream &json) {
+        json << "    ]\n  }\n}\n";
+    }
+
+    static void beginCycle(ostream &json, int cycle, bool first) {
+        if(!first) json << ",\n";
+        json << "      {\n        \"cycle\": " << cycle << ",\n";
+        json << "        \"allocations\": [\n";
+    }
+
+    static void endCycle(ostream &json) {
+        json << "\n        ]\n      }";
+    }
+
+    static void beginQueue(ostream &json, const string &queue, double quota, bool first) {
+        if(!first) json << ",\n";
+        json << "          {\n            \"queue\": \"" << queue << "\",\n";
+        json << "            \"quota\": " << quota << ",\n";
+        json << "            \"processes\": [\n";
+    }
+
+    static void endQueue(ostream &json) {
+        json << "            ]\n          }";
+    }
+
+    static void allocation(ostream &json, const string &process, double alloc, bool &first) {
+        if(!first) json << ",\n";
+        json << "              {\"process\": \"" << process 
+             << "\", \"allocated\": " << alloc << "}";
+        first = false;
+    }
+};
+
+// ==================== FICHIERS PROJETÉS ====================
+// Fichier en lecture seule projeté en mémoire (mmap), lu d'un bloc dans un
+// tampon sur les autres plateformes.
+class MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    ~MappedFile() {
+#if defined(__unix__) || defined(__APPLE__)
+        if(mapped) munmap(mapped, length);
+#endif
+    }
+
+    bool open(const string &path, string &error) {
+#if defined(__unix__) || defined(__APPLE__)
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if(fd < 0) { error = "impossible d'ouvrir " + path; return false; }
+        struct stat info;
+        if(fstat(fd, &info) == 0 && info.st_size > 0) {
+            length = info.st_size;
+            mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if(mapped == MAP_FAILED) mapped = nullptr;
+            else madvise(mapped, length, MADV_SEQUENTIAL);
+        }
+        ::close(fd);
+        if(!mapped) { error = "projection impossible de " + path; return false; }
+        bytes = static_cast<const char *>(mapped);
+#else
+        ifstream in(path, ios::binary);
+        if(!in) { error = "impossible d'ouvrir " + path; return false; }
+        fallback.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+        bytes = fallback.data();
+        length = fallback.size();
+#endif
+        return true;
+    }
+
+    const char *data() const { return bytes; }
+    size_t size() const { return length; }
+
+private:
+    const char *bytes = nullptr;
+    size_t length = 0;
+    void *mapped = nullptr;
+    vector<char> fallback;
+};
+
+// ==================== MÉMOIRE PARTAGÉE DES FRAGMENTS ====================
+// Région anonyme partagée (mmap MAP_SHARED) du moteur fragmenté, créée avant
+// les fork : par file, la demande publiée avant les quotas et les comptes du
+// cycle ; par fragment, ses processus vivants ; par processus, l'état final
+// rendu au parent. Chaque fragment n'écrit que les cases de ses files.
+// Barrière à génération : attente active, puis cession du processeur (les
+// attentes de std::atomic reposent sur des futex privés, qui ne traversent
+// pas les processus).
+#if defined(__unix__) || defined(__APPLE__)
+class ShardRegion {
+public:
+    // Par file
+    double *demand = nullptr;           // demande restante compensée, avant les quotas
+    double *cycleAllocated = nullptr;   // alloué pendant le cycle
+    double *queueTotal = nullptr;       // total alloué depuis le début
+    int32_t *active = nullptr;          // allocations du cycle
+    int32_t *finished = nullptr;        // processus terminés pendant le cycle
+    int32_t *cursor = nullptr;          // curseur RR en fin d'exécution
+    // Par fragment
+    int64_t *live = nullptr;
+    // Par processus, en fin d'exécution
+    double *remaining = nullptr;
+    double *allocated = nullptr;
+    double *waitTime = nullptr;
+    int32_t *startCycle = nullptr;
+    int32_t *endCycle = nullptr;
+    int32_t *priority = nullptr;
+    uint8_t *done = nullptr;
+
+    // Vérification périodique pendant une attente : faux si un autre
+    // participant a disparu (fils mort, parent mort)
+    function<bool()> watch;
+
+    ShardRegion() = default;
+    ShardRegion(const ShardRegion &) = delete;
+    ShardRegion &operator=(const ShardRegion &) = delete;
+
+    ~ShardRegion() {
+        if(base) munmap(base, length);
+    }
+
+    bool create(size_t shards, size_t queueCount, size_t slotCount, string &error) {
+        participants = shards;
+        length = layout(nullptr, shards, queueCount, slotCount);
+        void *mapped = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if(mapped == MAP_FAILED) {
+            error = string("mmap: ") + strerror(errno);
+            return false;
+        }
+        base = mapped;
+        layout(static_cast<char *>(base), shards, queueCount, slotCount);
+        return true;
+    }
+
+    size_t shards() const { return participants; }
+
+    // Faux si un participant a échoué : tous abandonnent
+    bool wait() {
+        uint32_t generation = control->generation.load(memory_order_acquire);
+        if(control->arrived.fetch_add(1, memory_order_acq_rel) + 1 == participants) {
+            control->arrived.store(0, memory_order_relaxed);
+            control->generation.store(generation + 1, memory_order_release);
+        } else {
+            for(unsigned spin = 1; control->generation.load(memory_order_acquire) == generation; spin++) {
+                if(control->failed.load(memory_order_relaxed)) return false;
+                if(spin < 256) continue;
+                this_thread::yield();
+                if(spin % 4096 == 0 && watch && !watch()) fail();
+            }
+        }
+        return !control->failed.load(memory_order_relaxed);
+    }
+
+    void fail() { control->failed.store(1, memory_order_relaxed); }
+
+private:
+    struct Control {
+        atomic<uint32_t> arrived{0};
+        atomic<uint32_t> generation{0};
+        atomic<uint32_t> failed{0};
+    };
+
+    Control *control = nullptr;
+    void *base = nullptr;
+    size_t length = 0;
+    size_t participants = 0;
+
+    // Tableaux alignés sur 64 octets ; bytes nul : taille seulement
+    size_t layout(char *bytes, size_t shards, size_t queueCount, size_t slotCount) {
+        size_t offset = 0;
+        auto carve = [&](auto *&array, size_t n) {
+            offset = (offset + 63) & ~size_t(63);
+            if(bytes) array = reinterpret_cast<remove_reference_t<decltype(array)>>(bytes + offset);
+            offset += n * sizeof(*array);
+        };
+        if(bytes) control = new(bytes) Control;
+        offset = sizeof(Control);
+        carve(demand, queueCount);
+        carve(cycleAllocated, queueCount);
+        carve(queueTotal, queueCount);
+        carve(active, queueCount);
+        carve(finished, queueCount);
+        carve(cursor, queueCount);
+        carve(live, shards);
+        carve(remaining, slotCount);
+        carve(allocated, slotCount);
+        carve(waitTime, slotCount);
+        carve(startCycle, slotCount);
+        carve(endCycle, slotCount);
+        carve(priority, slotCount);
+        carve(done, slotCount);
+        return max<size_t>(offset, 1);
+    }
+};
+#endif
+
+// ==================== TRACE BINAIRE ====================
+// Fichier .trc (ordre des octets natif) :
+//   en-tête : "S4TRACE1", u32 files, u32 processus, u32 taille de l'horodatage,
+//             u32 réservé, f64 ressource totale, puis les noms internés —
+//             files (u32 taille + octets), processus (i32 file + u32 taille +
+//             octets), horodatage — et un bourrage à 8 octets ;
+//   blocs   : u64 n, puis les colonnes f64 quantité[n], i32 cycle[n],
+//             i32 file[n], i32 processus[n], et un bourrage à 8 octets ;
+//   déclarations (noms apparus après l'en-tête : file ajoutée, processus
+//             admis en cours d'exécution), avant le bloc qui les utilise :
+//             u64 (bit 63 | n), puis n entrées i32 file (-1 : nouvelle file)
+//             + u32 taille + octets, et un bourrage à 8 octets.
+// Un enregistrement de processus -1 porte le quota de la file pour le cycle.
+// Les identifiants de processus sont stables pour toute la trace : ceux de
+// l'en-tête, dans son ordre, puis un par déclaration.
+struct TraceRecord {
+    int32_t cycle;
+    int32_t queue;
+    int32_t process;
+    double amount;
+};
+
+const uint64_t DeclarationChunk = 1ULL << 63;
+
+class TraceWriter {
+public:
+    static constexpr size_t BlockRecords = 1 << 16;
+
+    ~TraceWriter() { close(); }
+
+    bool open(const string &path) {
+        out.open(path, ios::binary | ios::trunc);
+        headerWritten = false;
+        return out.is_open();
+    }
+
+    bool isOpen() const { return out.is_open(); }
+    bool hasHeader() const { return headerWritten; }
+
+    void writeHeader(double totalResource, const string &timestamp, const vector<string> &queueNames,
+                     const vector<string> &processNames, const vector<int32_t> &processQueues) {
+        out.write("S4TRACE1", 8);
+        uint32_t counts[4] = {(uint32_t)queueNames.size(), (uint32_t)processNames.size(),
+                              (uint32_t)timestamp.size(), 0};
+        writeRaw(counts, 4);
+        writeRaw(&totalResource, 1);
+        for(const auto &name : queueNames) writeString(name);
+        for(size_t i = 0; i < processNames.size(); i++) {
+            writeRaw(&processQueues[i], 1);
+            writeString(processNames[i]);
+        }
+        out.write(timestamp.data(), timestamp.size());
+        pad();
+        headerWritten = true;
+    }
+
+    void declareQueue(const string &name) { declared.push_back({-1, name}); }
+    void declareProcess(int32_t queue, const string &name) { declared.push_back({queue, name}); }
+
+    void append(const TraceRecord &record) {
+        amounts.push_back(record.amount);
+        cycles.push_back(record.cycle);
+        queues.push_back(record.queue);
+        processes.push_back(record.process);
+        if(amounts.size() == BlockRecords) flushBlock();
+    }
+
+    void close() {
+        if(!out.is_open()) return;
+        flushBlock();
+        out.close();
+    }
+
+    // Processus fils (fork) : le fichier appartient au parent, plus rien n'y est écrit
+    void detach() { out.setstate(ios::badbit); }
+
+private:
+    ofstream out;
+    bool headerWritten = false;
+    vector<pair<int32_t, string>> declared;     // en attente du prochain bloc
+    vector<double> amounts;
+    vector<int32_t> cycles;
+    vector<int32_t> queues;
+    vector<int32_t> processes;
+
+    template<class T> void writeRaw(const T *data, size_t n) {
+        out.write(reinterpret_cast<const char *>(data), n * sizeof(T));
+    }
+
+    void writeString(const string &text) {
+        uint32_t size = text.size();
+        writeRaw(&size, 1);
+        out.write(text.data(), size);
+    }
+
+    void pad() {
+        static const char zeros[8] = {};
+        size_t over = (size_t)out.tellp() % 8;
+        if(over) out.write(zeros, 8 - over);
+    }
+
+    void flushBlock() {
+        if(!declared.empty()) {
+            uint64_t n = DeclarationChunk | declared.size();
+            writeRaw(&n, 1);
+            for(const auto &[queue, name] : declared) {
+                writeRaw(&queue, 1);
+                writeString(name);
+            }
+            pad();
+            declared.clear();
+        }
+        if(amounts.empty()) return;
+        uint64_t n = amounts.size();
+        writeRaw(&n, 1);
+        writeRaw(amounts.data(), n);
+        writeRaw(cycles.data(), n);
+        writeRaw(queues.data(), n);
+        writeRaw(processes.data(), n);
+        pad();
+        amounts.clear();
+        cycles.clear();
+        queues.clear();
+        processes.clear();
+    }
+};
+
+// Lecture par projection mémoire (lecture complète en repli hors POSIX) :
+// les colonnes des blocs pointent directement dans le fichier.
+class TraceReader {
+public:
+    struct Block {
+        size_t count;
+        const double *amount;
+        const int32_t *cycle;
+        const int32_t *queue;
+        const int32_t *process;
+    };
+
+    double totalResource = 0.0;
+    string timestamp;
+    vector<string> queueNames;
+    vector<string> processNames;
+    vector<int32_t> processQueues;
+    vector<Block> blocks;
+    size_t recordCount = 0;
+
+    bool open(const string &path, string &error) {
+        if(!file.open(path, error)) return false;
+        data = file.data();
+        size = file.size();
+        return parse(error);
+    }
+
+private:
+    MappedFile file;
+    const char *data = nullptr;
+    size_t size = 0;
+
+    bool parse(string &error) {
+        size_t pos = 0;
+        auto take = [&](size_t bytes) -> const char * {
+            if(pos + bytes > size) return nullptr;
+            const char *at = data + pos;
+            pos += bytes;
+            return at;
+        };
+        auto takeString = [&](string &text) {
+            const char *length = take(4);
+            if(!length) return false;
+            uint32_t n;
+            memcpy(&n, length, 4);
+            const char *bytes = take(n);
+            if(!bytes) return false;
+            text.assign(bytes, n);
+            return true;
+        };
+
+        const char *head = take(32);
+        if(!head || memcmp(head, "S4TRACE1", 8) != 0) { error = "en-tête de trace invalide"; return false; }
+        uint32_t counts[4];
+        memcpy(counts, head + 8, sizeof(counts));
+        memcpy(&totalResource, head + 24, sizeof(double));
+
+        queueNames.resize(counts[0]);
+        for(auto &name : queueNames) {
+            if(!takeString(name)) { error = "table des files tronquée"; return false; }
+        }
+        processNames.resize(counts[1]);
+        processQueues.resize(counts[1]);
+        for(size_t i = 0; i < counts[1]; i++) {
+            const char *queue = take(4);
+            if(!queue || !takeString(processNames[i])) { error = "table des processus tronquée"; return false; }
+            memcpy(&processQueues[i], queue, 4);
+        }
+        const char *stamp = take(counts[2]);
+        if(!stamp) { error = "horodatage tronqué"; return false; }
+        timestamp.assign(stamp, counts[2]);
+        pos = (pos + 7) & ~size_t(7);
+
+        while(pos < size) {
+            const char *header = take(8);
+            if(!header) { error = "bloc tronqué"; return false; }
+            uint64_t n;
+            memcpy(&n, header, 8);
+            if(n & DeclarationChunk) {
+                for(uint64_t k = 0; k < (n & ~DeclarationChunk); k++) {
+                    const char *queue = take(4);
+                    string name;
+                    if(!queue || !takeString(name)) { error = "déclarations tronquées"; return false; }
+                    int32_t q;
+                    memcpy(&q, queue, 4);
+                    if(q < 0) {
+                        queueNames.push_back(move(name));
+                    } else {
+                        processNames.push_back(move(name));
+                        processQueues.push_back(q);
+                    }
+                }
+                pos = (pos + 7) & ~size_t(7);
+                continue;
+            }
+            Block block;
+            block.count = n;
+            block.amount = reinterpret_cast<const double *>(take(n * sizeof(double)));
+            block.cycle = reinterpret_cast<const int32_t *>(take(n * 4));
+            block.queue = reinterpret_cast<const int32_t *>(take(n * 4));
+            block.process = reinterpret_cast<const int32_t *>(take(n * 4));
+            if(!block.amount || !block.cycle || !block.queue || !block.process) {
+                error = "bloc tronqué";
+                return false;
+            }
+            pos = (pos + 7) & ~size_t(7);
+            blocks.push_back(block);
+            recordCount += n;
+        }
+        return true;
+    }
+};
+
+// Trace binaire -> allocation_data.json, à l'identique du moteur
+bool convertTraceToJson(const string &tracePath, const string &jsonPath, string &error) {
+    TraceReader trace;
+    if(!trace.open(tracePath, error)) return false;
+    ofstream json(jsonPath);
+    if(!json) { error = "impossible d'écrire " + jsonPath; return false; }
+
+    JsonLayout::header(json, trace.totalResource, trace.timestamp);
+    int cycle = -1;
+    int queue = -1;
+    bool firstProcess = true;
+    for(const auto &block : trace.blocks) {
+        for(size_t r = 0; r < block.count; r++) {
+            if(block.process[r] < 0) {
+                // Quota : ouvre une file, et un cycle si le numéro change
+                if(queue >= 0) JsonLayout::endQueue(json);
+                if(block.cycle[r] != cycle) {
+                    if(cycle >= 0) JsonLayout::endCycle(json);
+                    JsonLayout::beginCycle(json, block.cycle[r], cycle < 0);
+                    cycle = block.cycle[r];
+                    queue = -1;
+                }
+                JsonLayout::beginQueue(json, trace.queueNames[block.queue[r]], block.amount[r], queue < 0);
+                queue = block.queue[r];
+                firstProcess = true;
+            } else {
+                JsonLayout::allocation(json, trace.processNames[block.process[r]], block.amount[r], firstProcess);
+            }
+        }
+    }
+    if(queue >= 0) JsonLayout::endQueue(json);
+    if(cycle >= 0) JsonLayout::endCycle(json);
+    JsonLayout::footer(json);
+    return true;
+}
+
+// ==================== JOURNAL ASYNCHRONE ====================
+// Événement de journal compact (24 octets), mis en forme par le thread écrivain
+struct LogEvent {
+    enum Kind : int32_t { CycleBegin, QueueBegin, Allocation, Finished, QueueEnd, CycleEnd };
+    double value;       // quota (QueueBegin) ou quantité allouée (Allocation)
+    int32_t id;         // cycle, indice de file ou slot de processus selon kind
+    int32_t extra;      // durée (Finished)
+    Kind kind;
+};
+
+// Anneau borné sans verrou, un producteur et un consommateur
+template<class T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t capacity) {
+        size_t size = 1;
+        while(size < capacity) size <<= 1;
+        slots.resize(size);
+        mask = size - 1;
+    }
+
+    size_t capacity() const { return slots.size(); }
+
+    size_t freeSpace() const {
+        return capacity() - (tail.load(memory_order_relaxed) - head.load(memory_order_acquire));
+    }
+
+    bool empty() const {
+        return head.load(memory_order_acquire) == tail.load(memory_order_acquire);
+    }
+
+    // Producteur : copie autant d'éléments que la place le permet
+    size_t push(const T *items, size_t n) {
+        size_t t = tail.load(memory_order_relaxed);
+        size_t k = min(n, capacity() - (t - head.load(memory_order_acquire)));
+        for(size_t i = 0; i < k; i++) slots[(t + i) & mask] = items[i];
+        tail.store(t + k, memory_order_release);
+        return k;
+    }
+
+    // Consommateur : retire jusqu'à n éléments
+    size_t pop(T *out, size_t n) {
+        size_t h = head.load(memory_order_relaxed);
+        size_t k = min(n, tail.load(memory_order_acquire) - h);
+        for(size_t i = 0; i < k; i++) out[i] = slots[(h + i) & mask];
+        head.store(h + k, memory_order_release);
+        return k;
+    }
+
+private:
+    vector<T> slots;
+    size_t mask = 0;
+    alignas(64) atomic<size_t> head{0};
+    alignas(64) atomic<size_t> tail{0};
+};
+
+// Anneau plein : le producteur attend (Block) ou abandonne l'événement en le
+// comptant (Drop).
+enum class LogOverflow { Block, Drop };
+
+// Thread écrivain qui vide l'anneau par lots vers `sink` ; le destructeur
+// vide l'anneau avant de rendre la main.
+class AsyncLog {
+public:
+    AsyncLog(size_t capacity, LogOverflow policy, function<void(const LogEvent *, size_t)> sink)
+        : ring(capacity), overflow(policy), sink(std::move(sink)), writer([this] { run(); }) {}
+
+    ~AsyncLog() {
+        stopping.store(true, memory_order_release);
+        writer.join();
+    }
+
+    // Événement de structure (début/fin de cycle) : jamais abandonné
+    void push(const LogEvent &event) { pushBlocking(&event, 1); }
+
+    // Événements indissociables (le bloc d'une file) : en mode Drop, le groupe
+    // est abandonné en entier plutôt que de laisser un bloc tronqué.
+    void pushGroup(const LogEvent *events, size_t n) {
+        if(overflow == LogOverflow::Drop && ring.freeSpace() < n) {
+            droppedEvents += n;
+            return;
+        }
+        pushBlocking(events, n);
+    }
+
+    // Attend que tout ce qui a été poussé soit écrit
+    void flush() {
+        while(written.load(memory_order_acquire) < pushed) this_thread::yield();
+    }
+
+    size_t dropped() const { return droppedEvents; }
+
+private:
+    SpscRing<LogEvent> ring;
+    LogOverflow overflow;
+    function<void(const LogEvent *, size_t)> sink;
+    size_t pushed = 0;                  // côté producteur uniquement
+    size_t droppedEvents = 0;
+    atomic<size_t> written{0};
+    atomic<bool> stopping{false};
+    thread writer;                      // dernier membre : démarre une fois l'état prêt
+
+    void pushBlocking(const LogEvent *events, size_t n) {
+        pushed += n;
+        while(n > 0) {
+            size_t k = ring.push(events, n);
+            events += k;
+            n -= k;
+            if(n > 0) this_thread::yield();
+        }
+    }
+
+    void run() {
+        vector<LogEvent> batch(4096);
+        while(true) {
+            size_t n = ring.pop(batch.data(), batch.size());
+            if(n > 0) {
+                sink(batch.data(), n);
+                written.fetch_add(n, memory_order_release);
+            } else if(stopping.load(memory_order_acquire)) {
+                if(ring.empty()) break;
+            } else {
+                this_thread::sleep_for(chrono::microseconds(50));
+            }
+        }
+    }
+};
+
+// ==================== CANAUX DE SOUMISSION ====================
+// Soumissions de processus par d'autres threads pendant que le moteur tourne :
+// un canal par file, plusieurs producteurs, un seul consommateur (le thread
+// du moteur, qui vide les canaux au début de chaque cycle). Sans verrou : un
+// lot est une chaîne de nœuds préparée hors du canal, accrochée d'un seul
+// compare-and-swap en tête d'une pile de Treiber ; le consommateur prend
+// toute la pile d'un échange et la retourne (ordre de soumission, lots
+// contigus). Aucun retrait élément par élément, donc pas d'ABA. Un canal qui
+// reçoit une soumission s'inscrit une fois dans la pile des canaux prêts :
+// le moteur ne visite que ceux-là.
+struct Submission {
+    enum Kind : int32_t { Admit, Cancel };
+    Kind kind = Admit;
+    int priority = 1;
+    double demand = 0.0;
+    uint64_t ticket = 0;        // Admit : attribué à la soumission ; Cancel : ticket visé
+    string name;                // vide : S<file>.<indice>
+    Submission *next = nullptr;
+};
+
+class SubmissionChannel {
+public:
+    SubmissionChannel(size_t queueIndex, atomic<SubmissionChannel *> &readyList)
+        : queue(queueIndex), ready(readyList) {}
+    SubmissionChannel(const SubmissionChannel &) = delete;
+    SubmissionChannel &operator=(const SubmissionChannel &) = delete;
+
+    ~SubmissionChannel() {
+        for(Submission *s = pending.load(); s;) {
+            Submission *next = s->next;
+            delete s;
+            s = next;
+        }
+    }
+
+    // ---------- Producteurs (tout thread) ----------
+    // Ticket de la soumission, à passer à cancel()
+    uint64_t submit(double demand, int priority, string name = "") {
+        uint64_t ticket = nextTicket.fetch_add(1, memory_order_relaxed);
+        Submission *s = new Submission{Submission::Admit, priority, demand, ticket, move(name)};
+        publish(s, s);
+        return ticket;
+    }
+
+    // Lot de n processus en une seule opération atomique ; tickets
+    // consécutifs à partir de la valeur rendue
+    uint64_t submitBatch(const double *demands, const int *priorities, size_t n) {
+        uint64_t first = nextTicket.fetch_add(n, memory_order_relaxed);
+        if(n == 0) return first;
+        Submission *top = nullptr, *bottom = nullptr;
+        for(size_t k = 0; k < n; k++) {
+            top = new Submission{Submission::Admit, priorities[k], demands[k], first + k, string(), top};
+            if(!bottom) bottom = top;
+        }
+        publish(top, bottom);
+        return first;
+    }
+
+    // Le processus est retiré au prochain cycle s'il est encore vivant
+    void cancel(uint64_t ticket) { cancelBatch(&ticket, 1); }
+
+    void cancelBatch(const uint64_t *tickets, size_t n) {
+        if(n == 0) return;
+        Submission *top = nullptr, *bottom = nullptr;
+        for(size_t k = 0; k < n; k++) {
+            top = new Submission{Submission::Cancel, 0, 0.0, tickets[k], string(), top};
+            if(!bottom) bottom = top;
+        }
+        publish(top, bottom);
+    }
+
+    uint64_t ticketsIssued() const { return nextTicket.load(memory_order_relaxed) - 1; }
+
+    // ---------- Consommateur (thread du moteur) ----------
+    size_t queueIndex() const { return queue; }
+
+    // Canaux inscrits depuis la dernière prise
+    static void takeReady(atomic<SubmissionChannel *> &readyList, vector<SubmissionChannel *> &out) {
+        out.clear();
+        for(SubmissionChannel *c = readyList.exchange(nullptr); c; c = c->nextReady) out.push_back(c);
+    }
+
+    // Soumissions en attente, dans l'ordre de soumission ; le canal peut se
+    // réinscrire dès l'entrée (une soumission concurrente attendra le cycle suivant)
+    Submission *takeAll() {
+        listed.store(false);
+        Submission *top = pending.exchange(nullptr), *ordered = nullptr;
+        while(top) {
+            Submission *next = top->next;
+            top->next = ordered;
+            ordered = top;
+            top = next;
+        }
+        return ordered;
+    }
+
+    // Admissions encore désignables par leur ticket (consommateur seulement) :
+    // une place réutilisée efface le ticket de son ancien occupant
+    unordered_map<uint64_t, int> admitted;     // ticket -> indice local
+    vector<uint64_t> slotTicket;                // indice local -> ticket (0 : aucun)
+
+private:
+    // Pile de Treiber : bottom->next prend l'ancienne tête, top devient la tête.
+    // Opérations séquentiellement cohérentes : un producteur qui trouve le
+    // canal déjà inscrit a publié avant que le consommateur ne le désinscrive.
+    void publish(Submission *top, Submission *bottom) {
+        Submission *head = pending.load(memory_order_relaxed);
+        do {
+            bottom->next = head;
+        } while(!pending.compare_exchange_weak(head, top));
+        if(listed.exchange(true)) return;
+        SubmissionChannel *first = ready.load(memory_order_relaxed);
+        do {
+            nextReady = first;
+        } while(!ready.compare_exchange_weak(first, this));
+    }
+
+    size_t queue;
+    atomic<SubmissionChannel *> &ready;
+    SubmissionChannel *nextReady = nullptr;
+    alignas(64) atomic<Submission *> pending{nullptr};
+    atomic<bool> listed{false};
+    atomic<uint64_t> nextTicket{1};
+};
+
+// Canaux d'un allocateur et bilan du consommateur
+struct SubmissionHub {
+    atomic<SubmissionChannel *> ready{nullptr};
+    vector<unique_ptr<SubmissionChannel>> channels;     // adresses stables
+    vector<SubmissionChannel *> drained;                // prise du cycle
+    long long admitted = 0;
+    long long cancelled = 0;
+    long long ignored = 0;      // demande invalide, ticket inconnu, terminé ou déjà annulé
+
+    void open(size_t qi) { channels.push_back(make_unique<SubmissionChannel>(qi, ready)); }
+};
+
+// ==================== REGISTRE DES POLITIQUES ====================
+// Politiques d'allocation intra-file, par nom. Chaque entrée pointe vers le
+// noyau ResourceAllocator::allocateGroup<Politique> (voir POLITIQUES), qui
+// sert une plage contiguë de files [begin, end) de cette politique.
+class ResourceAllocator;
+typedef void (ResourceAllocator::*PolicyKernel)(size_t begin, size_t end, double unit, bool buffered);
+
+struct PolicyEntry {
+    string name;
+    PolicyKernel kernel;
+    bool eventEngine;       // prise en charge par le moteur événementiel
+};
+
+class PolicyRegistry {
+public:
+    static constexpr int RoundRobin = 0;
+    static constexpr int Fifo = 1;
+
+    static const vector<PolicyEntry> &all() { return entries(); }
+
+    static int find(string_view name) {
+        const vector<PolicyEntry> &table = entries();
+        for(size_t id = 0; id < table.size(); id++) {
+            if(table[id].name == name) return id;
+        }
+        return -1;
+    }
+
+    template<class Policy> static int add();
+
+private:
+    static vector<PolicyEntry> &entries();
+};
+
+// Sélection du noyau : par plages de files consécutives de même politique,
+// ou comparaison du nom de politique file par file (ancienne répartition,
+// gardée pour le benchmark)
+enum class PolicyDispatch { Grouped, ByName };
+
+// Files consécutives [begin, end) d'une même politique
+struct PolicyRun {
+    int policyId;
+    size_t begin;
+    size_t end;
+};
+
+// ==================== CLASSE PRINCIPALE ====================
+class ResourceAllocator {
+private:
+    double totalResource;
+    vector<Queue> queues;
+    CycleHistory history;
+#if defined(SIM4_PROFILE)
+    PhaseProfiler profiler;
+#endif
+    string profilePath;             // profil des phases (SIM4_PROFILE), vide : pas de fichier
+    FrameRenderer renderer;         // interface terminal, redessinée par différence
+    bool liveView = false;          // trames plafonnées pendant runHeadless
+    ofstream logFile;
+    ofstream jsonFile;
+    int currentCycle = 0;
+    bool useAging = true;
+    double agingFactor = 0.05;
+    int liveProcesses = 0;          // processus non terminés, toutes files confondues
+    size_t shardBegin = 0;          // moteur fragmenté : files [shardBegin, shardEnd) de ce processus
+    size_t shardEnd = SIZE_MAX;
+    long long grantTotal = 0;       // allocations enregistrées depuis le début
+    ProcessTable table;             // état chaud des processus, fait foi pendant la simulation
+    vector<double> queueWeights;    // poids par file, aligné sur queues
+    vector<double> demandSums;      // demande restante par file, tenue à jour à chaque allocation
+    vector<double> demandErrors;    // compensation (Neumaier) des soustractions sur demandSums
+    vector<double> quotas;
+    QueueHierarchy hierarchy;       // groupes de files (vide : quotas à plat)
+
+    // Allocation multi-ressources (DRF), active si des ressources sont déclarées
+    struct DrfCandidate {
+        const ResourceVector *need;
+        double dominant;            // part dominante d'une unité allouée
+        double weight;
+        double remaining;
+        double served;              // unités allouées au cycle courant
+        int32_t queue;
+        int32_t process;
+        uint32_t mask;              // ressources à besoin non nul
+        bool queued;                // encore dans le tas
+    };
+    vector<string> resourceNames;
+    ResourceVector capacity;
+    ResourceVector inverseCapacity; // 1 / capacité, 0 hors des ressources déclarées
+    ResourceVector unitNeed;        // besoin d'un processus sans vecteur : 1 sur la première ressource
+    ResourceVector drfUsage;        // consommation du dernier cycle
+    bool weightedDrf = true;
+    vector<DrfCandidate> drfCandidates;
+    IndexedMinHeap<> drfHeap;
+    vector<vector<pair<int, double>>> drfGrants;    // tranches du cycle par file
+    unique_ptr<ThreadPool> pool;    // passes d'allocation parallèles (null : série)
+    vector<CycleStats> queueStats;  // statistiques partielles du cycle, une par file
+    vector<double> recordedTotals;  // totalAllocated des files au dernier cycle enregistré
+    vector<PolicyRun> policyRuns;           // plages de même politique, dans l'ordre des files
+    PolicyDispatch dispatch = PolicyDispatch::Grouped;
+    vector<double> cycleQueueAllocated;
+    vector<ostringstream> queueLogs;
+    vector<ostringstream> queueJson;
+    string timestamp;               // horodatage de la simulation (JSON, trace)
+    TraceWriter trace;              // trace binaire optionnelle
+    vector<vector<TraceRecord>> queueTrace;  // enregistrements du cycle, par file
+    // Identifiants de processus dans la trace, par file et indice local (-1 :
+    // à déclarer) : ceux de l'en-tête, puis un par processus admis ensuite.
+    // Ils ne suivent pas les slots, que growQueue renumérote.
+    vector<vector<int32_t>> traceIds;
+    int32_t nextTraceId = 0;
+    size_t tracedQueues = 0;        // files nommées dans la trace
+    bool captureGrants = false;     // mode service : enregistrements du cycle gardés pour la réponse
+    vector<TraceRecord> capturedRecords;
+    unique_ptr<AsyncLog> asyncLog;  // journal asynchrone (null : écriture directe)
+    unique_ptr<SubmissionHub> submissionHub;    // canaux de soumission (null : fermés)
+    vector<vector<LogEvent>> queueEvents;    // événements du cycle, par file
+    ostringstream logBatch;         // mise en forme côté écrivain, un lot à la fois
+    ostringstream jsonBatch;
+    bool writerFirstQueue = true;
+    bool writerFirstProcess = true;
+
+    // État paresseux d'une file pour le moteur événementiel. La position d'une
+    // visite RR est le couple (tour, indice) : l'ordre lexicographique de ces
+    // couples est l'ordre des visites, indépendamment des processus retirés.
+    typedef tuple<long long, int, unsigned> EventKey;   // (tour, indice, version)
+    struct EventQueueState {
+        bool fifoMode = false;
+        FenwickTree live;                   // processus vivants (indices locaux)
+        vector<double> syncRemaining;       // valeurs au dernier point de synchro
+        vector<double> syncAllocated;
+        vector<char> firstVisitDone;
+        // Round-Robin
+        long long round = 0;                // prochaine visite : (round, cursor)
+        int cursor = 0;
+        vector<long long> syncRound;
+        vector<int> syncIndex;
+        vector<unsigned> version;
+        priority_queue<EventKey, vector<EventKey>, greater<EventKey>> finishHeap;
+        priority_queue<EventKey, vector<EventKey>, greater<EventKey>> firstVisitHeap;
+        // FIFO
+        MinAddSegmentTree remaining;        // restant des vivants, +inf sinon
+        vector<int> pendingFirstVisit;      // indices croissants
+        size_t pendingPos = 0;
+    };
+    vector<EventQueueState> eventStates;
+
+    // Arrivées à venir, (cycle, slot) triées à la première admission
+    vector<pair<int, int32_t>> arrivals;
+    size_t nextArrival = 0;
+    bool arrivalsSorted = true;
+
+public:
+    // Chemin vide : pas de fichier. Les instances d'un balayage tournent ainsi
+    // en parallèle sans partager de descripteur (ni l'horodatage, non réentrant).
+    ResourceAllocator(double totalRes, const string &logPath = "allocation_log.txt",
+                      const string &jsonPath = "allocation_data.json") : totalResource(totalRes) {
+        if(logPath.empty()) logFile.setstate(ios::badbit);
+        else logFile.open(logPath);
+        if(jsonPath.empty()) jsonFile.setstate(ios::badbit);
+        else jsonFile.open(jsonPath);
+        if(logPath.empty() && jsonPath.empty()) return;
+
+        time_t now = time(0);
+        tm *ltm = localtime(&now);
+        timestamp = asctime(ltm);
+        
+        logFile << "═══════════════════════════════════════════════════════\n";
+        logFile << "  SIMULATION CAP-PRO-RATA - LOG DÉTAILLÉ\n";
+        logFile << "═══════════════════════════════════════════════════════\n";
+        logFile << "Date de simulation: " << timestamp;
+        logFile << "Ressource totale: " << totalResource << " unités\n";
+        logFile << "Aging activé: " << (useAging ? "OUI" : "NON") << "\n\n";
+        
+        JsonLayout::header(jsonFile, totalResource, timestamp);
+    }
+
+    ~ResourceAllocator() {
+        // Exécution terminée avant le premier cycle : trace valide, sans bloc
+        if(trace.isOpen() && !trace.hasHeader()) writeTraceHeader();
+        asyncLog.reset();
+        JsonLayout::footer(jsonFile);
+        logFile.close();
+        jsonFile.close();
+    }
+
+    void addQueue(Queue &q) { 
+        if(asyncLog) asyncLog->flush();    // l'écrivain lit les noms des files
+        queues.push_back(q); 
+        Queue &added = queues.back();
+        added.firstSlot = table.size();
+        for(const auto& p : added.processes) table.append(p, queues.size() - 1);
+        closeQueue();
+    }
+
+    // Construction en place (chargeur de scénarios) : openQueue() ajoute une
+    // file vide, appendProcess() y range chaque processus directement, et
+    // closeQueue() la termine. Les champs de la file (poids, politique, nom...)
+    // restent modifiables jusqu'à closeQueue() ; une seule file ouverte à la fois.
+    Queue &openQueue() {
+        if(asyncLog) asyncLog->flush();
+        queues.emplace_back();
+        queues.back().firstSlot = table.size();
+        return queues.back();
+    }
+
+    void appendProcess(string_view name, double demand, int priority, int arrivalCycle = 0,
+                       const ResourceVector &need = {}) {
+        Queue &q = queues.back();
+        q.processes.push_back({string(name), demand, demand, priority, false,
+                               0.0, -1, -1, 0.0, (double)priority, arrivalCycle, need});
+        table.append(q.processes.back(), queues.size() - 1);
+    }
+
+    void closeQueue() {
+        Queue &added = queues.back();
+        int policy = PolicyRegistry::find(added.policy);
+        added.policyId = policy >= 0 ? policy : PolicyRegistry::Fifo;   // nom inconnu : FIFO
+        size_t qi = queues.size() - 1;
+        if(!policyRuns.empty() && policyRuns.back().policyId == added.policyId) policyRuns.back().end = qi + 1;
+        else policyRuns.push_back({added.policyId, qi, qi + 1});
+        for(size_t i = 0; i < added.processes.size(); i++) {
+            int arrival = added.processes[i].arrivalCycle;
+            if(arrival <= max(currentCycle, 1)) continue;
+            size_t slot = added.firstSlot + i;
+            table.setFinished(slot);
+            if(!arrivals.empty() && arrivals.back().first > arrival) arrivalsSorted = false;
+            arrivals.push_back({arrival, (int32_t)slot});
+        }
+        queueWeights.push_back(added.weight);
+        hierarchy.addQueue(added.group);
+        history.addQueue();
+        recordedTotals.push_back(added.totalAllocated);
+        buildLiveIndex(added);
+        liveProcesses += added.liveCount;
+        demandSums.push_back(liveDemand(added));
+        demandErrors.push_back(0.0);
+        if(submissionHub) submissionHub->open(queues.size() - 1);
+    }
+
+    // ---------- Instantanés ----------
+    // État complet du moteur pas à pas entre deux cycles : files, processus
+    // (table SoA comprise), curseurs RR, états WFQ et PRIO, aging, cycle
+    // courant, arrivées à venir, hiérarchie, historique, ressources DRF.
+    // Journaux, trace et réglages d'exécution (threads, journal asynchrone,
+    // vue en direct) n'en font pas partie : l'allocateur restauré écrit ses
+    // propres fichiers à partir du cycle suivant. Les colonnes de la table
+    // sont rangées en blocs bruts, recopiés d'un memcpy depuis le fichier
+    // projeté ; seuls les noms sont relus un à un.
+    static constexpr char SnapshotMagic[8] = {'S', '4', 'S', 'N', 'A', 'P', '0', '1'};
+
+    void saveSnapshot(SnapshotWriter &out) {
+        syncProcessViews();
+        out.data.append(SnapshotMagic, 8);
+        out.put(array<uint32_t, 4>{1, sizeof(CycleStats), sizeof(ResourceVector), sizeof(void *)});
+        out.put(totalResource);
+        out.put(currentCycle);
+        out.put(useAging);
+        out.put(agingFactor);
+        out.put(grantTotal);
+        out.put(table.remaining);
+        out.put(table.allocated);
+        out.put(table.finishedMask);
+        out.put<uint64_t>(queues.size());
+        for(const auto &q : queues) {
+            out.put(q.name);
+            out.put(q.weight);
+            out.put(q.policy);
+            out.put(q.rrIndex);
+            out.put(q.totalAllocated);
+            out.put(q.quota);
+            out.put(q.color);
+            out.put(q.emoji);
+            out.put(q.group);
+            out.put<uint64_t>(q.processes.size());
+            for(const auto &p : q.processes) {
+                out.put(p.name);
+                out.put(p.demand);
+                out.put(p.priority);
+                out.put(p.startCycle);
+                out.put(p.endCycle);
+                out.put(p.waitTime);
+                out.put(p.basePriority);
+                out.put(p.arrivalCycle);
+                out.put(p.need);
+            }
+            out.put(q.freeSlots);
+            q.fair.save(out);
+            q.prio.save(out);
+        }
+        hierarchy.save(out);
+        history.save(out);
+        out.put(demandSums);
+        out.put(demandErrors);
+        out.put(recordedTotals);
+        out.put(resourceNames);
+        out.put(capacity);
+        out.put(inverseCapacity);
+        out.put(unitNeed);
+        out.put(weightedDrf);
+    }
+
+    bool writeSnapshot(const string &path, string &error) {
+        SnapshotWriter out;
+        saveSnapshot(out);
+        ofstream file(path, ios::binary | ios::trunc);
+        if(!file.write(out.data.data(), out.data.size()) || !file.flush()) {
+            error = "impossible d'écrire " + path;
+            return false;
+        }
+        return true;
+    }
+
+    // Restauration dans un allocateur sans file. Les files passent par
+    // openQueue() / closeQueue() (index des vivants, plages de politiques,
+    // arrivées à venir), puis l'état incrémental est recopié tel quel.
+    bool restoreSnapshot(const char *data, size_t size, string &error) {
+        if(!queues.empty()) {
+            error = "l'allocateur contient déjà des files";
+            return false;
+        }
+        SnapshotReader in(data, size);
+        auto corrupt = [&] {
+            error = "instantané tronqué ou incompatible";
+            return false;
+        };
+        array<uint32_t, 4> layout;
+        if(size < 8 || memcmp(data, SnapshotMagic, 8) != 0) {
+            error = "pas un instantané (S4SNAP01 attendu)";
+            return false;
+        }
+        in.p += 8;
+        if(!in.get(layout) || layout != array<uint32_t, 4>{1, sizeof(CycleStats), sizeof(ResourceVector), sizeof(void *)}) {
+            return corrupt();
+        }
+        vector<double> remaining, allocated;
+        vector<uint64_t> finishedMask;
+        uint64_t queueCount;
+        if(!(in.get(totalResource) && in.get(currentCycle) && in.get(useAging) && in.get(agingFactor) &&
+             in.get(grantTotal) && in.get(remaining) && in.get(allocated) && in.get(finishedMask) &&
+             in.get(queueCount)) ||
+           allocated.size() != remaining.size() || finishedMask.size() != (remaining.size() + 63) / 64) {
+            return corrupt();
+        }
+
+        for(uint64_t qi = 0; qi < queueCount; qi++) {
+            Queue &q = openQueue();
+            uint64_t processCount;
+            int rrIndex;
+            if(!(in.get(q.name) && in.get(q.weight) && in.get(q.policy) && in.get(rrIndex) &&
+                 in.get(q.totalAllocated) && in.get(q.quota) && in.get(q.color) && in.get(q.emoji) &&
+                 in.get(q.group) && in.get(processCount)) ||
+               processCount > remaining.size() - q.firstSlot) {
+                return corrupt();
+            }
+            q.processes.resize(processCount);
+            for(size_t i = 0; i < processCount; i++) {
+                Process &p = q.processes[i];
+                if(!(in.get(p.name) && in.get(p.demand) && in.get(p.priority) && in.get(p.startCycle) &&
+                     in.get(p.endCycle) && in.get(p.waitTime) && in.get(p.basePriority) &&
+                     in.get(p.arrivalCycle) && in.get(p.need))) {
+                    return corrupt();
+                }
+                size_t slot = q.firstSlot + i;
+                p.remaining = remaining[slot];
+                p.allocated = allocated[slot];
+                p.finished = (finishedMask[slot >> 6] >> (slot & 63)) & 1;
+                table.append(p, qi);
+            }
+            FairQueueState fair;
+            PriorityQueueState prio;
+            if(!(in.get(q.freeSlots) && fair.load(in) && prio.load(in))) return corrupt();
+            int group = q.group;
+            q.group = -1;           // hiérarchie relue en bloc plus bas
+            closeQueue();
+            Queue &closed = queues.back();
+            closed.group = group;
+            closed.rrIndex = rrIndex;
+            closed.fair = move(fair);
+            closed.prio = move(prio);
+        }
+        if(table.size() != remaining.size()) return corrupt();
+        table.finishedMask = move(finishedMask);    // arrivées à venir comprises
+
+        if(!(hierarchy.load(in) && history.load(in) && in.get(demandSums) && in.get(demandErrors) &&
+             in.get(recordedTotals) && in.get(resourceNames) && in.get(capacity) &&
+             in.get(inverseCapacity) && in.get(unitNeed) && in.get(weightedDrf) && in.atEnd()) ||
+           demandSums.size() != queueCount || demandErrors.size() != queueCount ||
+           recordedTotals.size() != queueCount || resourceNames.size() > MaxResources) {
+            return corrupt();
+        }
+        for(const auto &q : queues) {
+            if(q.group >= (int)hierarchy.groupCount()) return corrupt();
+        }
+        return true;
+    }
+
+    bool loadSnapshot(const string &path, string &error) {
+        MappedFile file;
+        return file.open(path, error) && restoreSnapshot(file.data(), file.size(), error);
+    }
+
+    // Moteur pas à pas jusqu'au cycle `cycle` au plus, sans rapport final ;
+    // faux si la simulation est terminée (ou bloquée)
+    bool advanceTo(int cycle, double unit) {
+        while(currentCycle < cycle && !allProcessesFinished()) {
+            currentCycle++;
+            runCycle(unit);
+            if(cycleWasIdle()) return false;
+        }
+        return !allProcessesFinished();
+    }
+
+    // Variantes « et si » à partir de l'état courant : chaque variante modifie
+    // une branche (poids, aging...) qui termine la simulation en headless.
+    // Sous Unix, une branche est un processus fils (fork) : il partage les
+    // pages du parent (table des processus comprise) en copie sur écriture et
+    // n'en duplique que ce qu'il modifie ; son résumé revient par un tube. Au
+    // plus `parallel` fils à la fois (0 : un par cœur). Ailleurs, chaque
+    // branche est restaurée d'un instantané en mémoire.
+    vector<RunSummary> forkVariants(const vector<function<void(ResourceAllocator &)>> &variants,
+                                    double unit, unsigned parallel, string &error) {
+        vector<RunSummary> results(variants.size());
+#if defined(__unix__) || defined(__APPLE__)
+        drainLogs();
+        logFile.flush();
+        jsonFile.flush();
+        size_t width = parallel > 0 ? parallel : max(1u, thread::hardware_concurrency());
+        for(size_t begin = 0; begin < variants.size(); begin += width) {
+            size_t end = min(variants.size(), begin + width);
+            vector<pair<pid_t, int>> children;
+            for(size_t k = begin; k < end; k++) {
+                int fds[2];
+                pid_t pid = -1;
+                if(pipe(fds) == 0) {
+                    pid = fork();
+                    if(pid < 0) {
+                        ::close(fds[0]);
+                        ::close(fds[1]);
+                    }
+                }
+                if(pid < 0) {
+                    error = string("fork: ") + strerror(errno);
+                    break;
+                }
+                if(pid == 0) {
+                    ::close(fds[0]);
+                    detachForkedChild();
+                    variants[k](*this);
+                    SnapshotWriter out;
+                    runHeadless(unit).save(out);
+                    for(size_t sent = 0; sent < out.data.size();) {
+                        ssize_t n = ::write(fds[1], out.data.data() + sent, out.data.size() - sent);
+                        if(n <= 0 && errno != EINTR) _exit(1);
+                        if(n > 0) sent += n;
+                    }
+                    _exit(0);
+                }
+                ::close(fds[1]);
+                children.push_back({pid, fds[0]});
+            }
+            // Un fils ne bloque que sur son propre tube : lecture dans l'ordre
+            for(size_t c = 0; c < children.size(); c++) {
+                auto [pid, fd] = children[c];
+                string reply;
+                char buffer[1 << 16];
+                ssize_t n;
+                while((n = ::read(fd, buffer, sizeof buffer)) != 0) {
+                    if(n > 0) reply.append(buffer, n);
+                    else if(errno != EINTR) break;
+                }
+                ::close(fd);
+                int status = 0;
+                while(waitpid(pid, &status, 0) < 0 && errno == EINTR) {}
+                SnapshotReader in(reply.data(), reply.size());
+                if(!WIFEXITED(status) || WEXITSTATUS(status) != 0 || !results[begin + c].load(in)) {
+                    if(error.empty()) error = "variante " + to_string(begin + c) + " : processus fils en échec";
+                }
+            }
+            if(!error.empty()) return {};
+        }
+#else
+        SnapshotWriter snapshot;
+        saveSnapshot(snapshot);
+        for(size_t k = 0; k < variants.size(); k++) {
+            ResourceAllocator branch(totalResource, "", "");
+            if(!branch.restoreSnapshot(snapshot.data.data(), snapshot.data.size(), error)) return {};
+            variants[k](branch);
+            results[k] = branch.runHeadless(unit);
+        }
+        (void)parallel;
+#endif
+        return results;
+    }
+
+    // ---------- Service ----------
+    // Allocateur piloté de l'extérieur (mode service, moteur pas à pas) : les
+    // processus entrent et sortent entre deux cycles. Un processus est désigné
+    // par (file, indice local) ; l'indice reste valable jusqu'à ce que le
+    // processus soit terminé (signalé par tick) ou retiré, puis sa place sert
+    // au prochain ajout dans la file.
+    struct CycleGrant {
+        int32_t queue;
+        int32_t process;    // indice local ; -1 : quota de la file
+        double amount;
+        bool finished;
+    };
+
+    // Indice local du processus ajouté, -1 si la file n'existe pas
+    int admitProcess(size_t qi, double demand, int priority) {
+        return admitAt(qi, demand, priority, currentCycle + 1);
+    }
+
+    // Admission pour le cycle `arrival` ; nom vide : S<file>.<indice>
+    int admitAt(size_t qi, double demand, int priority, int arrival, string name = "") {
+        if(qi >= queues.size() || !(demand > 0) || !isfinite(demand)) return -1;
+        if(queues[qi].freeSlots.empty()) growQueue(qi, max<size_t>(8, queues[qi].processes.size()));
+        Queue &q = queues[qi];
+        int i = q.freeSlots.back();
+        q.freeSlots.pop_back();
+        size_t slot = q.firstSlot + i;
+        if(name.empty()) name = "S" + to_string(qi) + "." + to_string(i);
+        forgetTraceId(qi, i);
+        q.processes[i] = {name, demand, demand, priority, false, 0.0, -1, -1, 0.0, (double)priority, arrival};
+        table.remaining[slot] = demand;
+        table.allocated[slot] = 0.0;
+        table.names[slot] = move(name);
+        table.clearFinished(slot);
+        linkArrived(q, i);
+        liveProcesses++;
+        consumeDemand(qi, -demand);
+        return i;
+    }
+
+    // Retire un processus vivant ; faux s'il n'existe pas ou n'est plus vivant
+    bool retireProcess(size_t qi, int i) {
+        if(qi >= queues.size() || i < 0 || (size_t)i >= queues[qi].processes.size()) return false;
+        Queue &q = queues[qi];
+        size_t slot = q.firstSlot + i;
+        if(q.processes[i].name.empty() || table.isFinished(slot)) return false;
+        table.setFinished(slot);
+        unlinkFinished(q, i);
+        liveProcesses--;
+        if(q.liveCount == 0) clearDemand(qi);
+        else consumeDemand(qi, table.remaining[slot]);
+        releaseSlot(q, i);
+        return true;
+    }
+
+    bool setQueueWeight(size_t qi, double weight) {
+        if(qi >= queues.size() || !(weight >= 0) || !isfinite(weight)) return false;
+        queues[qi].weight = weight;
+        queueWeights[qi] = weight;
+        return true;
+    }
+
+    // Change la politique d'une file (nom inconnu : faux) ; les plages de
+    // politiques sont recalculées
+    bool setQueuePolicy(size_t qi, const string &policy) {
+        int id = PolicyRegistry::find(policy);
+        if(qi >= queues.size() || id < 0) return false;
+        queues[qi].policy = policy;
+        queues[qi].policyId = id;
+        policyRuns.clear();
+        for(size_t k = 0; k < queues.size(); k++) {
+            int runPolicy = queues[k].policyId;
+            if(!policyRuns.empty() && policyRuns.back().policyId == runPolicy) policyRuns.back().end = k + 1;
+            else policyRuns.push_back({runPolicy, k, k + 1});
+        }
+        return true;
+    }
+
+    // Un cycle ; grants reçoit les quotas et les allocations du cycle, dans
+    // l'ordre des files. Les places des processus terminés sont libérées.
+    int tick(double unit, vector<CycleGrant> &grants) {
+        captureGrants = true;
+        capturedRecords.clear();
+        currentCycle++;
+        runCycle(unit);
+        grants.clear();
+        for(const auto &record : capturedRecords) {
+            int i = record.process < 0 ? -1 : record.process - queues[record.queue].firstSlot;
+            grants.push_back({record.queue, i, record.amount, false});
+        }
+        // Un processus terminé l'est sur sa dernière allocation du cycle
+        for(size_t k = grants.size(); k-- > 0;) {
+            CycleGrant &grant = grants[k];
+            if(grant.process < 0) continue;
+            Queue &q = queues[grant.queue];
+            if(!table.isFinished(q.firstSlot + grant.process) || q.processes[grant.process].name.empty()) continue;
+            grant.finished = true;
+            releaseSlot(q, grant.process);
+        }
+        return currentCycle;
+    }
+
+    // ---------- Canaux de soumission ----------
+    // Un canal par file, créé ici (avant le lancement des producteurs) ; une
+    // file ajoutée ensuite reçoit le sien. Les producteurs n'utilisent que les
+    // méthodes du canal (submit, submitBatch, cancel), sûres entre threads ;
+    // submissions() ne doit pas croiser un addQueue. Le moteur pas à pas vide
+    // les canaux au début de chaque cycle : un processus soumis est admis au
+    // cycle suivant sa soumission.
+    void enableSubmissions() {
+        if(submissionHub) return;
+        submissionHub = make_unique<SubmissionHub>();
+        for(size_t qi = 0; qi < queues.size(); qi++) submissionHub->open(qi);
+    }
+
+    SubmissionChannel &submissions(size_t qi) { return *submissionHub->channels[qi]; }
+    const SubmissionHub *submissionCounts() const { return submissionHub.get(); }
+
+    // ---------- Politiques ----------
+    // Vue d'une file pendant sa passe d'allocation : ce dont une politique a
+    // besoin (processus vivants, curseur, restants) et grant(), qui tient les
+    // comptes et les journaux comme le faisait chaque politique auparavant.
+    class QueuePass {
+    public:
+        QueuePass(ResourceAllocator &owner, size_t queueIndex, ostream &logStream, ostream &jsonStream)
+            : a(owner), qi(queueIndex), q(owner.queues[queueIndex]), stats(owner.queueStats[queueIndex]),
+              log(logStream), json(jsonStream) {}
+
+        double quota() const { return q.quota; }
+        int liveCount() const { return q.liveCount; }
+        int firstLive() const { return q.headLive; }
+        int nextLive(int i) const { return q.nextLive[i]; }
+        int cursor() const { return q.rrIndex; }
+        void setCursor(int i) { q.rrIndex = i; }
+        double remaining(int i) const { return a.table.remaining[q.firstSlot + i]; }
+        bool live(int i) const { return !a.table.isFinished(q.firstSlot + i); }
+        int size() const { return q.processes.size(); }
+        const Process &process(int i) const { return q.processes[i]; }
+        FairQueueState &fairState() { return q.fair; }
+        PriorityQueueState &priorityState() { return q.prio; }
+        double agingRate() const { return a.useAging ? a.agingFactor : 0.0; }
+        int cycle() const { return a.currentCycle; }
+
+        // Aging : un processus jamais servi gagne en priorité à chaque attente
+        void age(int i) {
+            Process &p = q.processes[i];
+            if(a.useAging && a.table.allocated[q.firstSlot + i] == 0 && a.currentCycle > 1) {
+                p.waitTime += 1.0;
+                p.priority = max(1, (int)(p.basePriority * (1 + a.agingFactor * p.waitTime)));
+            }
+        }
+
+        // Alloue `amount` au processus i ; vrai s'il vient de terminer (retiré
+        // des vivants, le curseur passe au suivant)
+        bool grant(int i, double amount) {
+            size_t slot = q.firstSlot + i;
+            Process &p = q.processes[i];
+            double &remaining = a.table.remaining[slot];
+            remaining -= amount;
+            a.table.allocated[slot] += amount;
+            a.consumeDemand(qi, amount);
+            q.totalAllocated += amount;
+            stats.totalAllocated += amount;
+            stats.activeProcesses++;
+
+            if(p.startCycle == -1) p.startCycle = a.currentCycle;
+
+            a.logAllocation(qi, slot, amount, firstProcess, log, json);
+
+            if(remaining > 0) return false;
+            a.table.setFinished(slot);
+            p.endCycle = a.currentCycle;
+            a.unlinkFinished(q, i);
+            stats.finishedProcesses++;
+            if(q.liveCount == 0) a.clearDemand(qi);
+            a.logFinished(qi, slot, p.endCycle - p.startCycle + 1, log);
+            return true;
+        }
+
+    private:
+        ResourceAllocator &a;
+        size_t qi;
+        Queue &q;
+        CycleStats &stats;
+        ostream &log;
+        ostream &json;
+        bool firstProcess = true;
+    };
+
+    // Noyau d'une politique : passe Policy::allocate (inlinée) sur les files
+    // consécutives [begin, end). buffered : blocs écrits dans les tampons par file.
+    template<class Policy>
+    void allocateGroup(size_t begin, size_t end, double unit, bool buffered) {
+        for(size_t qi = begin; qi < end; qi++) {
+            if(buffered) {
+                resetBuffer(queueLogs[qi], logFile);
+                resetBuffer(queueJson[qi], jsonFile);
+            }
+            ostream &log = buffered ? static_cast<ostream &>(queueLogs[qi]) : logFile;
+            ostream &json = buffered ? static_cast<ostream &>(queueJson[qi]) : jsonFile;
+
+            beginQueueBlock(qi, log, json);
+            QueuePass pass(*this, qi, log, json);
+            Policy::allocate(pass, pass.quota(), unit);
+            endQueueBlock(qi, json);
+        }
+    }
+
+    void setPolicyDispatch(PolicyDispatch mode) { dispatch = mode; }
+
+    // Trace binaire des allocations (moteur pas à pas) ; l'en-tête est écrit
+    // au premier cycle, une fois toutes les files ajoutées (à la destruction
+    // de l'allocateur si aucun cycle n'a tourné).
+    bool enableTrace(const string &path) {
+        if(timestamp.empty()) {
+            time_t now = time(0);
+            timestamp = asctime(localtime(&now));
+        }
+        return trace.open(path);
+    }
+
+    // Journal et JSON mis en forme par un thread écrivain à partir d'événements
+    // binaires ; les fichiers produits sont identiques à l'écriture directe.
+    // Les files doivent être ajoutées avant la simulation.
+    void enableAsyncLogging(size_t capacity = 1 << 16, LogOverflow overflow = LogOverflow::Block) {
+        asyncLog.reset();
+        logBatch.copyfmt(logFile);
+        jsonBatch.copyfmt(jsonFile);
+        logBatch.setstate(logFile.rdstate() & ios::badbit);
+        jsonBatch.setstate(jsonFile.rdstate() & ios::badbit);
+        asyncLog = make_unique<AsyncLog>(capacity, overflow, [this](const LogEvent *events, size_t n) {
+            writeLogEvents(events, n);
+        });
+    }
+
+    // Vue en direct du moteur seul : au plus `framesPerSecond` trames par
+    // seconde, quel que soit le nombre de cycles par seconde
+    void enableLiveView(double framesPerSecond) {
+        liveView = true;
+        renderer.setFrameRate(framesPerSecond);
+    }
+
+    // Fichier du profil des phases, écrit en fin de simulation (sans effet si
+    // le programme n'est pas compilé avec -DSIM4_PROFILE)
+    void setProfileOutput(const string &path) { profilePath = path; }
+
+    // Historique borné aux `window` derniers cycles (0 : illimité), les plus
+    // anciens regroupés par paquets de `downsample` cycles si downsample > 1
+    void setHistoryRetention(size_t window, size_t downsample = 0) {
+        history.configure(window, downsample);
+    }
+
+    const CycleHistory &cycleHistory() const { return history; }
+    size_t queueCount() const { return queues.size(); }
+    int cycle() const { return currentCycle; }
+    // Vues des processus à jour après une exécution (finishRun)
+    const Queue &queueAt(size_t qi) const { return queues[qi]; }
+    size_t processCount() const { return table.size(); }
+
+    // Ressources (CPU, mémoire, E/S...) et leurs capacités par cycle : le
+    // moteur pas à pas alloue alors par DRF, pondéré par le poids des files si
+    // `weighted`. Les besoins des processus déjà ajoutés doivent tenir dans
+    // les ressources déclarées.
+    bool setResources(const vector<string> &names, const vector<double> &capacities, bool weighted,
+                      string &error) {
+        if(names.empty() || names.size() > MaxResources || names.size() != capacities.size()) {
+            error = "entre 1 et " + to_string(MaxResources) + " ressources attendues";
+            return false;
+        }
+        ResourceVector cap, inverse;
+        for(size_t r = 0; r < names.size(); r++) {
+            if(!(capacities[r] > 0) || !isfinite(capacities[r])) {
+                error = "capacité invalide pour " + names[r];
+                return false;
+            }
+            cap[r] = capacities[r];
+            inverse[r] = 1.0 / capacities[r];
+        }
+        for(const auto &q : queues) {
+            for(const auto &p : q.processes) {
+                for(size_t r = names.size(); r < MaxResources; r++) {
+                    if(p.need[r] != 0) {
+                        error = p.name + " : besoin sur la ressource " + to_string(r + 1) + ", " +
+                                to_string(names.size()) + " déclarées";
+                        return false;
+                    }
+                }
+            }
+        }
+        resourceNames = names;
+        capacity = cap;
+        inverseCapacity = inverse;
+        unitNeed = {};
+        unitNeed[0] = 1.0;
+        weightedDrf = weighted;
+        return true;
+    }
+
+    bool multiResource() const { return !resourceNames.empty(); }
+
+    // Ressource distribuée par cycle : le total, ou la plus grande capacité en DRF
+    double cycleCapacity() const {
+        if(!multiResource()) return totalResource;
+        double largest = 0.0;
+        for(size_t r = 0; r < resourceNames.size(); r++) largest = max(largest, capacity[r]);
+        return largest;
+    }
+
+    // Groupe de files sous `parent` (-1 : racine) ; les files s'y rattachent
+    // par Queue::group. Retourne l'indice du groupe.
+    int addGroup(string_view name, double weight, int parent = -1) {
+        return hierarchy.addGroup(name, weight, parent);
+    }
+    int findGroup(string_view name) const { return hierarchy.findGroup(name); }
+    size_t groupCount() const { return hierarchy.groupCount(); }
+
+    void setAging(bool enabled, double factor) {
+        useAging = enabled;
+        agingFactor = factor;
+    }
+
+    // Passes d'allocation par file sur `threads` threads (0 : tous les cœurs,
+    // 1 : série). Journaux et JSON restent dans l'ordre des files.
+    void setThreads(unsigned threads) {
+        if(threads == 0) threads = max(1u, thread::hardware_concurrency());
+        if(threads == 1) pool.reset();
+        else pool = make_unique<ThreadPool>(threads);
+    }
+
+    // Recopie l'état chaud de la table dans Queue::processes (affichage, rapport)
+    void syncProcessViews() {
+        for(auto &q : queues) {
+            for(size_t i = 0; i < q.processes.size(); i++) {
+                size_t slot = q.firstSlot + i;
+                q.processes[i].remaining = table.remaining[slot];
+                q.processes[i].allocated = table.allocated[slot];
+                q.processes[i].finished = table.isFinished(slot) && q.processes[i].arrivalCycle <= currentCycle;
+            }
+        }
+    }
+
+    void showInitialState() {
+        Display::clearScreen();
+        Display::printBanner(cout);
+        Display::printHeader(cout, "🔧 CONFIGURATION INITIALE DU SYSTÈME");
+        
+        cout << "\n\033[1;37m📦 FILES D'ATTENTE CONFIGURÉES:\033[0m\n\n";
+        
+        double totalWeight = 0;
+        for(const auto& q : queues) totalWeight += q.weight;
+        
+        int fileNum = 1;
+        for(const auto& q : queues) {
+            double quota = (q.weight / totalWeight) * totalResource;
+            double percentage = (q.weight / totalWeight) * 100;
+            
+            cout << "  " << q.emoji << " \033[1;37mFile " << fileNum++ << ": " 
+                 << q.color << q.name << "\033[0m\n";
+            cout << "     ├─ Politique       : " << q.policy << "\n";
+            cout << "     ├─ Poids           : " << fixed << setprecision(3) << q.weight 
+                 << " (" << setprecision(1) << percentage << "%)\n";
+            cout << "     ├─ Quota théorique : " << setprecision(1) << quota << " unités\n";
+            cout << "     └─ Processus       : " << q.processes.size() << "\n";
+            
+            for(const auto& p : q.processes) {
+                cout << "         • " << p.name << " (demande: " 
+                     << setprecision(1) << p.demand << " unités)\n";
+            }
+            cout << "\n";
+        }
+
+        Display::printResourceGrid(cout, totalResource, queues);
+        Display::printAllocationTable(cout, queues);
+
+        drainLogs();
+        logFile << "═══ CONFIGURATION INITIALE ═══\n";
+        for(const auto& q : queues) {
+            logFile << q.name << " (" << q.policy << "): " 
+                   << q.processes.size() << " processus\n";
+        }
+        logFile << "\n";
+    }
+
+    bool allProcessesFinished() {
+        return liveProcesses == 0 && nextArrival == arrivals.size();
+    }
+
+    void simulate(double unit, int cycleDelay = 2000, bool autoMode = false) {
+        showInitialState();
+        
+        if(!autoMode) {
+            cout << "\n\n";
+            Display::printSeparator(cout, "═");
+            cout << "\033[1;33m⚡ Appuyez sur ENTRÉE pour démarrer la simulation...\033[0m\n";
+            Display::printSeparator(cout, "═");
+            cin.get();
+        } else {
+            cout << "\n\033[1;32m🚀 Mode automatique activé - démarrage dans 2 secondes...\033[0m\n";
+            this_thread::sleep_for(chrono::milliseconds(2000));
+        }
+
+        // CYCLES D'ALLOCATION
+        while(!allProcessesFinished()) {
+            currentCycle++;
+            this_thread::sleep_for(chrono::milliseconds(cycleDelay));
+            runCycle(unit);
+            if(renderer.due()) {
+                PHASE_TIMER(profiler, Phase::Render);
+                renderCycle(history.back());
+            }
+            if(cycleWasIdle()) break;
+            
+            if(!autoMode && currentCycle == 1) {
+                cout << "\n\n";
+                Display::printSeparator(cout, "═");
+                cout << "\033[1;33m⏭️  Appuyez sur ENTRÉE pour continuer...\033[0m\n";
+                Display::printSeparator(cout, "═");
+                cin.ignore();
+                cin.get();
+                renderer.invalidate();
+            }
+        }
+
+        showFinalReport();
+    }
+
+    // Moteur seul : ni affichage, ni pause, ni lecture clavier.
+    // Les journaux fichiers restent écrits ; seul le terminal est épargné.
+    RunSummary runHeadless(double unit) {
+        auto start = chrono::steady_clock::now();
+
+        while(!allProcessesFinished()) {
+            currentCycle++;
+            runCycle(unit);
+            if(liveView && renderer.due()) renderCycle(history.back());
+            if(cycleWasIdle()) break;
+        }
+        if(liveView && !history.empty()) renderCycle(history.back());
+
+        return finishRun(start, "headless");
+    }
+
+    // Moteur événementiel : même résultat que runHeadless, au bit près
+    // (allocations, cycles de début et de fin, historique, rapport final),
+    // mais les visites pleines à `unit` sont appliquées en bloc entre deux
+    // événements (fin de processus, première visite, visite partielle). Les
+    // quotas dépendant de la demande restante, chaque cycle est parcouru et
+    // ses quotas recalculés : O(files) par cycle + O(log n) par événement, sans
+    // saut au-dessus des cycles. Pas de trace par allocation dans ce mode.
+    RunSummary runEventDriven(double unit) {
+        auto start = chrono::steady_clock::now();
+
+        bool coveredPolicies = all_of(queues.begin(), queues.end(), [](const Queue &q) {
+            return PolicyRegistry::all()[q.policyId].eventEngine;
+        });
+        if(!exactBatching(unit) || !coveredPolicies || multiResource() || submissionHub) {
+            // Regroupement inexact en flottant, politique sans équivalent
+            // événementiel, DRF ou canaux de soumission (vidés par runCycle) :
+            // on retombe sur le pas à pas
+            drainLogs();
+            if(submissionHub) {
+                logFile << "Moteur événementiel: canaux de soumission ouverts, exécution cycle par cycle\n";
+            } else if(multiResource()) {
+                logFile << "Moteur événementiel: allocation multi-ressources (DRF), exécution cycle par cycle\n";
+            } else if(!coveredPolicies) {
+                logFile << "Moteur événementiel: politique hors RR/FIFO, exécution cycle par cycle\n";
+            } else {
+                logFile << "Moteur événementiel: quantum " << unit
+                        << " non dyadique, exécution cycle par cycle\n";
+            }
+            while(!allProcessesFinished()) {
+                currentCycle++;
+                runCycle(unit);
+                if(cycleWasIdle()) break;
+            }
+            return finishRun(start, "événementiel, repli pas à pas");
+        }
+
+        buildEventStates(unit);
+        while(!allProcessesFinished()) {
+            currentCycle++;
+            CycleStats stats;
+            stats.cycleNumber = currentCycle;
+            stats.activeProcesses = 0;
+            stats.totalAllocated = 0;
+
+            admitArrivals(unit);
+            computeCycleQuotas(unit);
+            for(size_t qi = 0; qi < queues.size(); qi++) {
+                queues[qi].quota = quotas[qi];
+                // Comptes partiels par file, fusionnés dans l'ordre des files
+                // comme dans runCycle : mêmes additions que le pas à pas
+                CycleStats queueCycle{};
+                if(eventStates[qi].fifoMode) eventFifo(qi, quotas[qi], unit, queueCycle);
+                else eventRoundRobin(qi, quotas[qi], unit, queueCycle);
+                stats.activeProcesses += queueCycle.activeProcesses;
+                stats.totalAllocated += queueCycle.totalAllocated;
+                stats.finishedProcesses += queueCycle.finishedProcesses;
+            }
+
+            stats.utilization = (stats.totalAllocated / totalResource) * 100;
+            recordCycle(stats);
+            if(cycleWasIdle()) break;
+        }
+        materializeEventStates(unit);
+
+        return finishRun(start, "événementiel");
+    }
+
+    // Moteur pas à pas réparti sur `shards` processus (0 : un par cœur). Les
+    // files sont découpées en plages contiguës de tailles voisines (en
+    // processus) ; le parent traite la première, un fils (fork) chacune des
+    // autres. À chaque cycle, deux barrières sur une région partagée : chaque
+    // fragment publie la demande de ses files, puis tous calculent les quotas
+    // sur le tableau complet (mêmes opérations dans le même ordre : quotas
+    // identiques au moteur en un seul processus) et allouent leurs files ;
+    // ensuite chacun publie ses comptes, que tous cumulent dans l'ordre des
+    // files (historique, condition d'arrêt). En fin d'exécution, les fils
+    // rendent au parent l'état de leurs processus (région) et celui de leurs
+    // files WFQ et PRIO (tube, au format des instantanés). Pas de journal par cycle ni
+    // de JSON (leurs blocs suivent l'ordre des files) ; avec une trace binaire,
+    // le DRF (tas global) ou des canaux de soumission (leurs producteurs sont
+    // des threads du parent), repli sur un seul processus. En cas d'échec
+    // d'un fragment, error est renseigné et l'état de l'allocateur est perdu.
+    RunSummary runSharded(double unit, unsigned shards, string &error) {
+        if(shards == 0) shards = max(1u, thread::hardware_concurrency());
+        shards = min<size_t>(shards, queues.size());
+        if(shards <= 1) return runHeadless(unit);
+        auto start = chrono::steady_clock::now();
+#if defined(__unix__) || defined(__APPLE__)
+        if(multiResource() || trace.isOpen() || captureGrants || submissionHub) {
+#endif
+            drainLogs();
+            logFile << "Moteur fragmenté: "
+                    << (multiResource() ? "allocation multi-ressources (DRF)"
+                        : trace.isOpen() ? "trace binaire demandée"
+                        : submissionHub ? "canaux de soumission ouverts" : "plateforme sans fork")
+                    << ", exécution en un seul processus\n";
+            while(!allProcessesFinished()) {
+                currentCycle++;
+                runCycle(unit);
+                if(cycleWasIdle()) break;
+            }
+            return finishRun(start, "fragmenté, repli un processus");
+#if defined(__unix__) || defined(__APPLE__)
+        }
+
+        // Plages de files : coupure dès que la part de processus est atteinte,
+        // ou quand il ne reste qu'une file par plage à venir
+        size_t nq = queues.size();
+        vector<size_t> bounds = {0};
+        size_t seen = 0;
+        for(size_t qi = 0; qi + 1 < nq && bounds.size() < shards; qi++) {
+            seen += queues[qi].processes.size();
+            size_t cuts = bounds.size();
+            if(seen * shards >= table.size() * cuts || nq - (qi + 1) == shards - cuts) bounds.push_back(qi + 1);
+        }
+        bounds.push_back(nq);
+
+        ShardRegion region;
+        if(!region.create(shards, nq, table.size(), error)) return {};
+        drainLogs();
+        logFile.flush();
+        jsonFile.flush();
+
+        size_t shard = 0;
+        pid_t parent = getpid();
+        vector<pid_t> children;
+        vector<int> stateFds;       // par fils : tube de l'état de ses files (parent)
+        int stateFd = -1;           // fils : extrémité d'écriture de son tube
+        for(size_t s = 1; s < shards; s++) {
+            int fds[2];
+            pid_t pid = -1;
+            if(pipe(fds) == 0) {
+                pid = fork();
+                if(pid < 0) {
+                    ::close(fds[0]);
+                    ::close(fds[1]);
+                }
+            }
+            if(pid < 0) {
+                error = string("fork: ") + strerror(errno);
+                region.fail();
+                break;
+            }
+            if(pid == 0) {
+                ::close(fds[0]);
+                for(int fd : stateFds) ::close(fd);
+                stateFds.clear();
+                stateFd = fds[1];
+                shard = s;
+                children.clear();
+                break;
+            }
+            ::close(fds[1]);
+            children.push_back(pid);
+            stateFds.push_back(fds[0]);
+        }
+
+        // Le parent tient le journal ; ses passes n'y écrivent rien
+        unique_ptr<AsyncLog> parkedLog;
+        ios::iostate logState = logFile.rdstate(), jsonState = jsonFile.rdstate();
+        if(shard == 0) {
+            parkedLog = move(asyncLog);
+            logFile.setstate(ios::badbit);
+            jsonFile.setstate(ios::badbit);
+            region.watch = [&children] {
+                int status;
+                for(pid_t pid : children) {
+                    if(waitpid(pid, &status, WNOHANG) != 0) return false;
+                }
+                return true;
+            };
+        } else {
+            detachForkedChild();
+            region.watch = [parent] { return getppid() == parent; };
+        }
+
+        shardBegin = bounds[shard];
+        shardEnd = bounds[shard + 1];
+        int liveTotal = liveProcesses;
+        liveProcesses = 0;
+        for(size_t qi = shardBegin; qi < shardEnd; qi++) liveProcesses += queues[qi].liveCount;
+        queueStats.resize(nq);
+
+        bool ok = error.empty();
+        while(ok && !(liveTotal == 0 && nextArrival == arrivals.size())) {
+            currentCycle++;
+            ok = runShardCycle(region, shard, unit, liveTotal);
+            if(ok && cycleWasIdle()) break;
+        }
+
+        if(shard > 0) {
+            for(size_t qi = shardBegin; qi < shardEnd; qi++) {
+                Queue &q = queues[qi];
+                region.cursor[qi] = q.rrIndex;
+                for(size_t i = 0; i < q.processes.size(); i++) {
+                    size_t slot = q.firstSlot + i;
+                    const Process &p = q.processes[i];
+                    region.remaining[slot] = table.remaining[slot];
+                    region.allocated[slot] = table.allocated[slot];
+                    region.done[slot] = table.isFinished(slot);
+                    region.waitTime[slot] = p.waitTime;
+                    region.startCycle[slot] = p.startCycle;
+                    region.endCycle[slot] = p.endCycle;
+                    region.priority[slot] = p.priority;
+                }
+            }
+            // États WFQ et PRIO : taille variable (tas), hors de la région
+            SnapshotWriter out;
+            for(size_t qi = shardBegin; qi < shardEnd; qi++) {
+                queues[qi].fair.save(out);
+                queues[qi].prio.save(out);
+            }
+            for(size_t sent = 0; ok && sent < out.data.size();) {
+                ssize_t n = ::write(stateFd, out.data.data() + sent, out.data.size() - sent);
+                if(n <= 0 && errno != EINTR) ok = false;
+                if(n > 0) sent += n;
+            }
+            _exit(ok ? 0 : 1);
+        }
+
+        // Un fils ne bloque que sur son propre tube : lecture dans l'ordre
+        vector<string> states(children.size());
+        for(size_t c = 0; c < children.size(); c++) {
+            char buffer[1 << 16];
+            ssize_t n;
+            while((n = ::read(stateFds[c], buffer, sizeof buffer)) != 0) {
+                if(n > 0) states[c].append(buffer, n);
+                else if(errno != EINTR) break;
+            }
+            ::close(stateFds[c]);
+            int status = 0;
+            pid_t waited;
+            while((waited = waitpid(children[c], &status, 0)) < 0 && errno == EINTR) {}
+            if(waited < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) ok = false;
+        }
+        shardBegin = 0;
+        shardEnd = SIZE_MAX;
+        asyncLog = move(parkedLog);
+        logFile.clear(logState);
+        jsonFile.clear(jsonState);
+        liveProcesses = liveTotal;
+        if(!ok) {
+            if(error.empty()) error = "fragment en échec (processus fils)";
+            return {};
+        }
+
+        // Files des fils : état final des processus repris de la région, index
+        // des vivants reconstruit, puis états WFQ/PRIO repris du tube (la
+        // reconstruction de l'index les invalide)
+        for(size_t qi = bounds[1]; qi < nq; qi++) {
+            Queue &q = queues[qi];
+            for(size_t i = 0; i < q.processes.size(); i++) {
+                size_t slot = q.firstSlot + i;
+                Process &p = q.processes[i];
+                table.remaining[slot] = region.remaining[slot];
+                table.allocated[slot] = region.allocated[slot];
+                if(region.done[slot]) table.setFinished(slot);
+                else table.clearFinished(slot);
+                p.waitTime = region.waitTime[slot];
+                p.startCycle = region.startCycle[slot];
+                p.endCycle = region.endCycle[slot];
+                p.priority = region.priority[slot];
+            }
+            q.quota = quotas[qi];
+            q.rrIndex = region.cursor[qi];
+            buildLiveIndex(q);
+            demandSums[qi] = liveDemand(q);
+            demandErrors[qi] = 0.0;
+        }
+        for(size_t c = 0; c < states.size(); c++) {
+            SnapshotReader in(states[c].data(), states[c].size());
+            bool read = true;
+            for(size_t qi = bounds[c + 1]; read && qi < bounds[c + 2]; qi++) {
+                read = queues[qi].fair.load(in) && queues[qi].prio.load(in);
+            }
+            if(!read || !in.atEnd()) {
+                error = "fragment " + to_string(c + 1) + " : état des files illisible";
+                return {};
+            }
+        }
+
+        logFile << "Moteur fragmenté: " << shards << " processus, files par fragment:";
+        for(size_t s = 0; s < shards; s++) logFile << " " << bounds[s + 1] - bounds[s];
+        logFile << "\n";
+        return finishRun(start, "fragmenté");
+#endif
+    }
+
+private:
+    // Allocation de chaque file sur le cycle : écart des totaux cumulés
+    void recordCycle(const CycleStats &stats) {
+        size_t nq = queues.size();
+        cycleQueueAllocated.resize(nq);
+        for(size_t qi = 0; qi < nq; qi++) {
+            cycleQueueAllocated[qi] = queues[qi].totalAllocated - recordedTotals[qi];
+            recordedTotals[qi] = queues[qi].totalAllocated;
+        }
+        history.push(stats, cycleQueueAllocated.data());
+        grantTotal += stats.activeProcesses;
+    }
+
+    // Un cycle sans aucune visite laisse l'état inchangé : la simulation est bloquée
+    // (poids ou demandes nuls), inutile de boucler indéfiniment. Tant que des
+    // arrivées restent à venir, un cycle vide est seulement une attente.
+    bool cycleWasIdle() const {
+        return !history.empty() && history.back().activeProcesses == 0 && nextArrival == arrivals.size();
+    }
+
+    RunSummary finishRun(chrono::steady_clock::time_point start, const string &mode) {
+        RunSummary summary;
+        summary.cycles = currentCycle;
+        summary.wallSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        summary.cyclesPerSecond = summary.wallSeconds > 0 ? summary.cycles / summary.wallSeconds : 0.0;
+        syncProcessViews();
+        drainLogs();
+        summary.meanUtilization = history.meanUtilization();
+        long long responseTotal = 0, finished = 0, waitTotal = 0, arrived = 0;
+        int responseMax = 0;
+        map<int, pair<long long, long long>> waitCounts;    // priorité -> (somme, nombre)
+        for(const auto &q : queues) {
+            int done = 0;
+            for(const auto &p : q.processes) {
+                if(p.arrivalCycle <= currentCycle) {
+                    int wait = p.waitCycles(currentCycle);
+                    int priority = lround(p.basePriority);
+                    waitTotal += wait;
+                    arrived++;
+                    summary.maxWait = max(summary.maxWait, wait);
+                    waitCounts[priority].first += wait;
+                    waitCounts[priority].second++;
+                    auto &byPriority = summary.waitByPriority[priority];
+                    byPriority.second = max(byPriority.second, wait);
+                }
+                if(p.finished) {
+                    responseTotal += p.responseCycles();
+                    responseMax = max(responseMax, p.responseCycles());
+                    finished++;
+                }
+                if(done >= 0) done = p.finished ? max(done, p.endCycle) : -1;
+            }
+            summary.queueCompletion.push_back(done);
+        }
+        summary.meanResponse = finished > 0 ? (double)responseTotal / finished : 0.0;
+        summary.meanWait = arrived > 0 ? (double)waitTotal / arrived : 0.0;
+        for(const auto &[priority, counts] : waitCounts) {
+            summary.waitByPriority[priority].first = (double)counts.first / counts.second;
+        }
+        summary.allocations = grantTotal;
+        writeProfile();
+
+        logFile << "\n═══════════════════════════════════════\n";
+        logFile << "RESULTAT FINAL (mode " << mode << ")\n";
+        logFile << "═══════════════════════════════════════\n";
+        logFile << "Cycles totaux: " << summary.cycles << "\n";
+        if(!allProcessesFinished()) {
+            logFile << "⚠️  Simulation bloquée: " << liveProcesses << " processus sans quota\n";
+        }
+        if(asyncLog && asyncLog->dropped() > 0) {
+            logFile << "⚠️  Journal asynchrone: " << asyncLog->dropped() << " événements abandonnés\n";
+        }
+        logFile << "Temps de réponse: moyen " << fixed << setprecision(2) << summary.meanResponse
+                << " cycles, max " << responseMax << " cycles\n";
+        logFile << "Attente avant premier service: moyenne " << summary.meanWait
+                << " cycles, max " << summary.maxWait << " cycles\n";
+        if(multiResource()) {
+            logFile << "Ressources (" << (weightedDrf ? "DRF pondéré" : "DRF") << "):";
+            for(size_t r = 0; r < resourceNames.size(); r++) {
+                logFile << " " << resourceNames[r] << "=" << capacity[r];
+            }
+            logFile << "\n";
+        }
+        if(submissionHub) {
+            logFile << "Soumissions: admises=" << submissionHub->admitted << " annulées=" << submissionHub->cancelled
+                    << " ignorées=" << submissionHub->ignored << "\n";
+        }
+        logFile << "Durée: " << fixed << setprecision(6) << summary.wallSeconds << " s\n";
+        logFile << "Cycles/s: " << setprecision(1) << summary.cyclesPerSecond << "\n";
+        return summary;
+    }
+
+    void runCycle(double unit) {
+        PHASE_TIMER(profiler, Phase::Cycle);
+        CycleStats stats;
+        stats.cycleNumber = currentCycle;
+        stats.activeProcesses = 0;
+        stats.totalAllocated = 0;
+
+        {
+            PHASE_TIMER(profiler, Phase::Logs);
+            if(asyncLog) {
+                asyncLog->push({0.0, currentCycle, 0, LogEvent::CycleBegin});
+            } else {
+                LogLayout::cycleHeader(logFile, currentCycle);
+                JsonLayout::beginCycle(jsonFile, currentCycle, currentCycle == 1);
+            }
+        }
+
+        {
+            PHASE_TIMER(profiler, Phase::Admission);
+            drainSubmissions();
+            admitArrivals(unit);
+        }
+        {
+            PHASE_TIMER(profiler, Phase::Quotas);
+            if(multiResource()) allocateDrf(unit);
+            else computeCycleQuotas(unit);
+        }
+        if(trace.isOpen() && !trace.hasHeader()) writeTraceHeader();
+
+        // Chaque file ne touche que ses processus : les passes d'allocation sont
+        // indépendantes. Statistiques partielles par file, fusionnées ensuite
+        // dans l'ordre des files (même résultat en série et en parallèle).
+        size_t nq = queues.size();
+        queueStats.resize(nq);
+        if(recordsWanted()) queueTrace.resize(nq);
+        if(asyncLog) queueEvents.resize(nq);
+        bool buffered;
+        {
+            // En écriture directe, les lignes de journal des allocations sont
+            // écrites au fil des passes : leur durée va aux journaux
+            PHASE_TIMER_SPLIT(profiler, Phase::Allocation, Phase::Logs);
+            buffered = multiResource() ? replayDrf() : allocateQueues(unit);
+        }
+        if(buffered) {
+            PHASE_TIMER(profiler, Phase::Logs);
+            for(size_t qi = 0; qi < nq; qi++) {
+                logFile << queueLogs[qi].view();
+                jsonFile << queueJson[qi].view();
+            }
+        }
+        for(size_t qi = 0; qi < nq; qi++) {
+            stats.activeProcesses += queueStats[qi].activeProcesses;
+            stats.totalAllocated += queueStats[qi].totalAllocated;
+            stats.finishedProcesses += queueStats[qi].finishedProcesses;
+        }
+        liveProcesses -= stats.finishedProcesses;
+        if(recordsWanted()) {
+            PHASE_TIMER(profiler, Phase::Records);
+            for(auto &records : queueTrace) {
+                if(trace.isOpen()) {
+                    for(const auto &record : records) trace.append(tracedRecord(record));
+                }
+                if(captureGrants) capturedRecords.insert(capturedRecords.end(), records.begin(), records.end());
+                records.clear();
+            }
+        }
+
+        {
+            PHASE_TIMER(profiler, Phase::Logs);
+            if(asyncLog) {
+                for(auto &events : queueEvents) {
+                    asyncLog->pushGroup(events.data(), events.size());
+                    events.clear();
+                }
+                asyncLog->push({0.0, currentCycle, 0, LogEvent::CycleEnd});
+            } else {
+                JsonLayout::endCycle(jsonFile);
+            }
+        }
+
+        // Calcul utilisation (DRF : ressource la plus consommée)
+        stats.utilization = multiResource() ? Kernels::dominantShare(drfUsage, inverseCapacity) * 100
+                                            : (stats.totalAllocated / totalResource) * 100;
+
+        {
+            PHASE_TIMER(profiler, Phase::History);
+            recordCycle(stats);
+        }
+        if(!asyncLog) {
+            PHASE_TIMER(profiler, Phase::Logs);
+            LogLayout::cycleEnd(logFile);
+        }
+    }
+
+    // Cycle DRF, décision : remplissage progressif sur les processus vivants.
+    // Le tas donne le processus de plus petite part dominante (÷ poids de sa
+    // file en DRF pondéré) ; il reçoit une tranche d'au plus `unit`, bornée
+    // par son reste et par la capacité libre. Un processus qui ne tient plus
+    // sort du tas pour le cycle (la capacité libre ne fait que baisser). Les
+    // besoins étant proportionnels, la part dominante vaut servi × dominante
+    // d'une unité : une tranche coûte O(log n) plus trois noyaux à 8 voies.
+    // Une ressource épuisée (résidu d'arrondi compris) exclut d'un coup ceux
+    // qui en ont besoin : dès qu'aucun candidat restant ne tient, le cycle
+    // s'arrête sans dépiler les autres.
+    void allocateDrf(double unit) {
+        size_t nq = queues.size();
+        drfCandidates.clear();
+        for(size_t qi = 0; qi < nq; qi++) {
+            const Queue &q = queues[qi];
+            double weight = weightedDrf ? queueWeights[qi] : 1.0;
+            if(!(weight > 0)) continue;
+            for(int i = q.headLive, k = 0; k < q.liveCount; i = q.nextLive[i], k++) {
+                const ResourceVector *need = q.processes[i].need.empty() ? &unitNeed : &q.processes[i].need;
+                uint32_t mask = 0;
+                for(size_t r = 0; r < resourceNames.size(); r++) mask |= uint32_t((*need)[r] > 0) << r;
+                drfCandidates.push_back({need, Kernels::dominantShare(*need, inverseCapacity), weight,
+                                         table.remaining[q.firstSlot + i], 0.0, (int32_t)qi, i, mask, true});
+            }
+        }
+        drfHeap.reset(drfCandidates.size());
+        for(size_t c = 0; c < drfCandidates.size(); c++) drfHeap.push(c, 0.0);
+        drfGrants.resize(nq);
+        for(auto &grants : drfGrants) grants.clear();
+
+        ResourceVector free = capacity;
+        uint32_t exhausted = 0;
+        size_t fitting = drfCandidates.size();     // candidats du tas sans ressource épuisée
+        while(fitting > 0) {
+            int c = drfHeap.pop();
+            DrfCandidate &x = drfCandidates[c];
+            x.queued = false;
+            if(x.mask & exhausted) continue;
+            fitting--;
+            double amount = min({unit, x.remaining, Kernels::fitScale(free, *x.need)});
+            Kernels::subtractScaled(free, *x.need, amount);
+            x.remaining -= amount;
+            x.served += amount;
+            drfGrants[x.queue].push_back({x.process, amount});
+            if(x.remaining > 0 && amount == unit) {
+                drfHeap.push(c, x.served * x.dominant / x.weight);
+                x.queued = true;
+                fitting++;
+            }
+
+            uint32_t now = exhausted;
+            for(size_t r = 0; r < resourceNames.size(); r++) {
+                if(free[r] <= capacity[r] * 1e-12) {
+                    free[r] = 0.0;
+                    now |= 1u << r;
+                }
+            }
+            if(now != exhausted) {
+                exhausted = now;
+                fitting = 0;
+                for(const auto &y : drfCandidates) fitting += y.queued && !(y.mask & exhausted);
+            }
+        }
+        for(size_t r = 0; r < MaxResources; r++) drfUsage[r] = capacity[r] - free[r];
+
+        quotas.assign(nq, 0.0);
+        for(size_t qi = 0; qi < nq; qi++) {
+            for(const auto &grant : drfGrants[qi]) quotas[qi] += grant.second;
+        }
+    }
+
+    // Cycle DRF, application : les tranches de chaque file sont rejouées dans
+    // l'ordre des files par QueuePass::grant (journaux et comptes habituels,
+    // quota de la file = total de ses tranches)
+    bool replayDrf() {
+        for(size_t qi = 0; qi < queues.size(); qi++) {
+            beginQueueBlock(qi, logFile, jsonFile);
+            QueuePass pass(*this, qi, logFile, jsonFile);
+            for(const auto &[process, amount] : drfGrants[qi]) pass.grant(process, amount);
+            endQueueBlock(qi, jsonFile);
+        }
+        return false;
+    }
+
+    // Passes des files [begin, end), dans l'ordre des files : un appel de
+    // noyau par plage de même politique (allocateGroup<Politique>)
+    void allocateRange(size_t begin, size_t end, double unit, bool buffered) {
+        const vector<PolicyEntry> &policies = PolicyRegistry::all();
+        auto run = upper_bound(policyRuns.begin(), policyRuns.end(), begin,
+                               [](size_t qi, const PolicyRun &r) { return qi < r.end; });
+        for(; run != policyRuns.end() && run->begin < end; ++run) {
+            (this->*policies[run->policyId].kernel)(max(begin, run->begin), min(end, run->end), unit, buffered);
+        }
+    }
+
+    // Passes d'allocation du cycle, par plages de files consécutives de même
+    // politique : l'ordre des files est conservé, l'écriture directe dans les
+    // fichiers reste possible. Vrai si les blocs de journal sont restés dans
+    // les tampons par file (à recopier ensuite).
+    bool allocateQueues(double unit) {
+        size_t nq = queues.size();
+        if(pool && nq > 1) {
+            // Journal asynchrone : seuls les événements par file sont remplis
+            bool buffered = !asyncLog;
+            if(buffered) {
+                queueLogs.resize(nq);
+                queueJson.resize(nq);
+            }
+            size_t grain = max<size_t>(1, nq / (pool->size() * 8));
+            pool->parallelFor(nq, grain, [&](size_t begin, size_t end) {
+                allocateRange(begin, end, unit, buffered);
+            });
+            return buffered;
+        }
+        if(dispatch == PolicyDispatch::ByName) {
+            // Nom résolu à chaque passe, comme closeQueue() (nom inconnu : FIFO)
+            const vector<PolicyEntry> &policies = PolicyRegistry::all();
+            for(size_t qi = 0; qi < nq; qi++) {
+                int id = PolicyRegistry::find(queues[qi].policy);
+                (this->*policies[id >= 0 ? id : PolicyRegistry::Fifo].kernel)(qi, qi + 1, unit, false);
+            }
+        } else {
+            allocateRange(0, nq, unit, false);
+        }
+        return false;
+    }
+
+    // Ouverture du bloc d'une file : quota du cycle, statistiques partielles, en-têtes
+    void beginQueueBlock(size_t qi, ostream &log, ostream &json) {
+        Queue &q = queues[qi];
+        CycleStats &partial = queueStats[qi];
+        partial.activeProcesses = 0;
+        partial.totalAllocated = 0;
+        partial.finishedProcesses = 0;
+        q.quota = quotas[qi];
+
+        if(asyncLog) {
+            queueEvents[qi].push_back({q.quota, (int32_t)qi, 0, LogEvent::QueueBegin});
+        } else {
+            WRITE_TIMER(profiler, &log == &logFile);
+            JsonLayout::beginQueue(json, q.name, q.quota, qi == 0);
+            LogLayout::queueHeader(log, q.name, q.policy, q.quota);
+        }
+        if(recordsWanted()) queueTrace[qi].push_back({currentCycle, (int32_t)qi, -1, q.quota});
+    }
+
+    void endQueueBlock(size_t qi, ostream &json) {
+        if(asyncLog) {
+            queueEvents[qi].push_back({0.0, (int32_t)qi, 0, LogEvent::QueueEnd});
+            return;
+        }
+        WRITE_TIMER(profiler, &json == &jsonFile);
+        JsonLayout::endQueue(json);
+    }
+
+    // Profil des phases vers profilePath ; vrai s'il a été écrit
+    bool writeProfile() {
+#if defined(SIM4_PROFILE)
+        if(profilePath.empty()) return false;
+        if(profiler.write(profilePath)) return true;
+        cerr << "Profil: impossible d'écrire " << profilePath << "\n";
+#endif
+        return false;
+    }
+
+    // Tampon réutilisé d'un cycle à l'autre, au format courant du flux cible
+    static void resetBuffer(ostringstream &buffer, const ostream &target) {
+        buffer.str("");
+        buffer.clear();
+        buffer.copyfmt(target);
+        buffer.setstate(target.rdstate() & ios::badbit);   // flux désactivé : rien à formater
+    }
+
+    // Interface terminal d'un cycle, posée au-dessus du moteur : une trame
+    // dont seules les lignes changées sont envoyées au terminal
+    void renderCycle(const CycleStats& stats) {
+        syncProcessViews();
+        ostream &frame = renderer.beginFrame();
+        Display::printBanner(frame);
+        Display::printHeader(frame, "🔄 CYCLE D'ALLOCATION", currentCycle);
+
+        Display::printCycleMetrics(frame, currentCycle, stats, totalResource);
+        Display::printResourceGrid(frame, totalResource, queues);
+        {
+            PHASE_TIMER(profiler, Phase::RenderTable);
+            Display::printAllocationTable(frame, queues);
+        }
+        {
+            PHASE_TIMER(profiler, Phase::RenderProgress);
+            Display::printDetailedProgress(frame, queues, totalResource);
+        }
+        renderer.present();
+    }
+
+    // Soustraction compensée : sans elle, la demande tenue à jour dérive de la
+    // somme réelle des restants au fil des cycles. Une soustraction exacte
+    // laisse la compensation inchangée, ce qui garde les blocs du moteur
+    // événementiel identiques au pas à pas.
+    void consumeDemand(size_t qi, double amount) {
+        double &sum = demandSums[qi];
+        double t = sum - amount;
+        if(fabs(sum) >= fabs(amount)) demandErrors[qi] += (sum - t) - amount;
+        else demandErrors[qi] += (-amount - t) + sum;
+        sum = t;
+    }
+
+    void clearDemand(size_t qi) {
+        demandSums[qi] = 0.0;
+        demandErrors[qi] = 0.0;
+    }
+
+    // Soumissions des canaux inscrits depuis le cycle précédent, dans l'ordre
+    // des files : admissions au cycle courant, annulations des processus
+    // encore vivants (un ticket inconnu, terminé ou déjà annulé est ignoré)
+    void drainSubmissions() {
+        if(!submissionHub) return;
+        SubmissionHub &hub = *submissionHub;
+        SubmissionChannel::takeReady(hub.ready, hub.drained);
+        sort(hub.drained.begin(), hub.drained.end(), [](const SubmissionChannel *a, const SubmissionChannel *b) {
+            return a->queueIndex() < b->queueIndex();
+        });
+        for(SubmissionChannel *channel : hub.drained) {
+            size_t qi = channel->queueIndex();
+            for(Submission *s = channel->takeAll(); s;) {
+                if(s->kind == Submission::Admit) admitSubmission(*channel, qi, *s);
+                else cancelSubmission(*channel, qi, s->ticket);
+                Submission *next = s->next;
+                delete s;
+                s = next;
+            }
+        }
+    }
+
+    void admitSubmission(SubmissionChannel &channel, size_t qi, Submission &s) {
+        // Place libérée réutilisée : l'écrivain asynchrone lit peut-être encore l'ancien nom
+        if(asyncLog && !queues[qi].freeSlots.empty()) drainLogs();
+        int i = admitAt(qi, s.demand, s.priority, currentCycle, move(s.name));
+        if(i < 0) {
+            submissionHub->ignored++;
+            return;
+        }
+        if(channel.slotTicket.size() < queues[qi].processes.size()) {
+            channel.slotTicket.resize(queues[qi].processes.size(), 0);
+        }
+        if(channel.slotTicket[i]) channel.admitted.erase(channel.slotTicket[i]);
+        channel.slotTicket[i] = s.ticket;
+        channel.admitted[s.ticket] = i;
+        submissionHub->admitted++;
+    }
+
+    void cancelSubmission(SubmissionChannel &channel, size_t qi, uint64_t ticket) {
+        auto found = channel.admitted.find(ticket);
+        if(found != channel.admitted.end()) {
+            int i = found->second;
+            channel.admitted.erase(found);
+            channel.slotTicket[i] = 0;
+            if(retireProcess(qi, i)) {
+                submissionHub->cancelled++;
+                return;
+            }
+        }
+        submissionHub->ignored++;
+    }
+
+    // Processus arrivés au cycle courant : liés aux vivants de leur file, leur
+    // demande ajoutée à la somme tenue à jour (sans recalcul de la file)
+    void admitArrivals(double unit) {
+        if(!arrivalsSorted) {
+            sort(arrivals.begin() + nextArrival, arrivals.end());
+            arrivalsSorted = true;
+        }
+        while(nextArrival < arrivals.size() && arrivals[nextArrival].first <= currentCycle) {
+            size_t slot = arrivals[nextArrival++].second;
+            size_t qi = table.queueId[slot];
+            if(qi < shardBegin || qi >= shardEnd) continue;     // file d'un autre fragment
+            Queue &q = queues[qi];
+            int i = slot - q.firstSlot;
+            table.clearFinished(slot);
+            linkArrived(q, i);
+            liveProcesses++;
+            consumeDemand(qi, -table.remaining[slot]);
+            if(!eventStates.empty()) admitEventState(qi, i, unit);
+        }
+    }
+
+    // Quotas du cycle à partir des demandes restantes (partagé par les deux moteurs)
+    // Sous un quantum de demande, les restants ne sont plus que des résidus :
+    // la somme tenue à jour n'a plus de chiffres significatifs, on la recalcule.
+    void computeCycleQuotas(double unit) {
+        for(size_t qi = 0; qi < queues.size(); qi++) settleDemand(qi, unit);
+        quotasFromDemand();
+    }
+
+    void settleDemand(size_t qi, double unit) {
+        demandSums[qi] += demandErrors[qi];
+        demandErrors[qi] = 0.0;
+        if(demandSums[qi] < unit && queues[qi].liveCount > 0) {
+            demandSums[qi] = exactDemand(qi, unit);
+        }
+    }
+
+    void quotasFromDemand() {
+        size_t nq = queues.size();
+        quotas.resize(nq);
+        if(!hierarchy.empty()) {
+            hierarchy.evaluate(queueWeights.data(), demandSums.data(), totalResource);
+            for(size_t qi = 0; qi < nq; qi++) quotas[qi] = hierarchy.quota(qi);
+            return;
+        }
+        double totalWeight = Kernels::weightedTotal(queueWeights.data(), demandSums.data(), nq);
+        Kernels::computeQuotas(queueWeights.data(), demandSums.data(), totalWeight,
+                               totalResource, quotas.data(), nq);
+    }
+
+#if defined(__unix__) || defined(__APPLE__)
+    // Un cycle du moteur fragmenté sur les files [shardBegin, shardEnd). Les
+    // demandes et les comptes des autres fragments sont lus dans la région
+    // après chaque barrière. Faux si un fragment a échoué.
+    bool runShardCycle(ShardRegion &region, size_t shard, double unit, int &liveTotal) {
+        size_t nq = queues.size();
+        admitArrivals(unit);
+        for(size_t qi = shardBegin; qi < shardEnd; qi++) {
+            settleDemand(qi, unit);
+            region.demand[qi] = demandSums[qi];
+        }
+        if(!region.wait()) return false;
+        for(size_t qi = 0; qi < nq; qi++) {
+            if(qi < shardBegin || qi >= shardEnd) demandSums[qi] = region.demand[qi];
+        }
+        quotasFromDemand();
+
+        allocateRange(shardBegin, shardEnd, unit, false);
+        for(size_t qi = shardBegin; qi < shardEnd; qi++) {
+            region.cycleAllocated[qi] = queueStats[qi].totalAllocated;
+            region.active[qi] = queueStats[qi].activeProcesses;
+            region.finished[qi] = queueStats[qi].finishedProcesses;
+            region.queueTotal[qi] = queues[qi].totalAllocated;
+            liveProcesses -= queueStats[qi].finishedProcesses;
+        }
+        region.live[shard] = liveProcesses;
+        if(!region.wait()) return false;
+
+        // Comptes de tous les fragments, cumulés dans l'ordre des files comme runCycle
+        CycleStats stats;
+        stats.cycleNumber = currentCycle;
+        stats.activeProcesses = 0;
+        stats.totalAllocated = 0;
+        for(size_t qi = 0; qi < nq; qi++) {
+            stats.activeProcesses += region.active[qi];
+            stats.totalAllocated += region.cycleAllocated[qi];
+            stats.finishedProcesses += region.finished[qi];
+            queues[qi].totalAllocated = region.queueTotal[qi];
+        }
+        liveTotal = 0;
+        for(size_t s = 0; s < region.shards(); s++) liveTotal += region.live[s];
+        stats.utilization = (stats.totalAllocated / totalResource) * 100;
+        recordCycle(stats);
+        return true;
+    }
+#endif
+
+    // ---------- Moteur événementiel ----------
+    // Regrouper k visites pleines (x - k*unit au lieu de k soustractions) ne
+    // donne le même flottant que si unit = m * 2^-s et que toutes les grandeurs
+    // restent sous 2^(52-s) : chaque soustraction est alors exacte, et une
+    // addition n'arrondit qu'en changeant de binade (repeatedSum).
+    bool exactBatching(double unit) const {
+        if(!(unit > 0) || !isfinite(unit)) return false;
+        int s = 0;
+        double scaled = unit;
+        while(scaled != floor(scaled) && s < 40) { scaled *= 2; s++; }
+        if(scaled != floor(scaled) || scaled >= ldexp(1.0, 52)) return false;
+
+        double bound = totalResource;
+        for(double d : demandSums) bound += d;
+        for(size_t k = nextArrival; k < arrivals.size(); k++) bound += table.remaining[arrivals[k].second];
+        return bound < ldexp(1.0, 50 - s);
+    }
+
+    // Résultat de k additions successives a += unit, chacune arrondie comme
+    // dans le pas à pas. Sous les bornes d'exactBatching, unit est un multiple
+    // du pas flottant de a : les additions qui restent dans la binade de a
+    // sont exactes (regroupées), seule celle qui en sort arrondit. O(1) si a
+    // est un multiple de unit (aucune visite partielle) ou si la somme reste
+    // dans sa binade, sinon proportionnel aux binades traversées.
+    static double repeatedSum(double a, double unit, long long k) {
+        double multiple = a / unit;
+        if(multiple == floor(multiple) && multiple * unit == a) return a + k * unit;
+        while(k > 0) {
+            if(a > 0) {
+                uint64_t binade = bit_cast<uint64_t>(a) >> 52;
+                double sum = a + k * unit;
+                if(bit_cast<uint64_t>(sum) >> 52 == binade) return sum;
+                double limit = bit_cast<double>((binade + 1) << 52);
+                long long j = (long long)((limit - a) / unit);
+                while(j > 0 && a + j * unit >= limit) j--;
+                while(a + (j + 1) * unit < limit) j++;
+                a += j * unit;
+                k -= j;
+            }
+            a += unit;
+            k--;
+        }
+        return a;
+    }
+
+    static long long fullVisits(double left, double unit) {
+        long long m = (long long)floor(left / unit);
+        while(m > 0 && left - m * unit < 0) m--;
+        while(left - (m + 1) * unit >= 0) m++;
+        return m;
+    }
+
+    // Numéro (à partir de 1) de la visite pleine qui termine un processus
+    static long long visitsToFinish(double remaining, double unit) {
+        long long k = max(1LL, (long long)ceil(remaining / unit));
+        while(k > 1 && remaining - (k - 1) * unit <= 0) k--;
+        while(remaining - k * unit > 0) k++;
+        return k;
+    }
+
+    void buildEventStates(double unit) {
+        eventStates.assign(queues.size(), EventQueueState());
+        for(size_t qi = 0; qi < queues.size(); qi++) {
+            Queue &q = queues[qi];
+            EventQueueState &st = eventStates[qi];
+            int n = q.processes.size();
+
+            vector<char> flags(n);
+            st.syncRemaining.resize(n);
+            st.syncAllocated.resize(n);
+            st.firstVisitDone.assign(n, 1);
+            for(int i = 0; i < n; i++) {
+                size_t slot = q.firstSlot + i;
+                flags[i] = !table.isFinished(slot);
+                st.syncRemaining[i] = table.remaining[slot];
+                st.syncAllocated[i] = table.allocated[slot];
+                if(flags[i] && (q.processes[i].startCycle == -1 || table.allocated[slot] == 0)) {
+                    st.firstVisitDone[i] = 0;
+                }
+            }
+            st.live.build(flags);
+
+            st.fifoMode = q.policyId == PolicyRegistry::Fifo;
+            if(st.fifoMode) {
+                vector<double> values(n, numeric_limits<double>::infinity());
+                for(int i = 0; i < n; i++) {
+                    if(flags[i]) values[i] = st.syncRemaining[i];
+                    if(!st.firstVisitDone[i]) st.pendingFirstVisit.push_back(i);
+                }
+                st.remaining.build(values);
+                continue;
+            }
+
+            st.round = 0;
+            st.cursor = q.liveCount > 0 ? q.rrIndex : 0;
+            st.syncRound.assign(n, 0);
+            st.syncIndex.assign(n, st.cursor);
+            st.version.assign(n, 0);
+            for(int i = 0; i < n; i++) {
+                if(!flags[i]) continue;
+                pushFinishKey(st, i, unit);
+                if(!st.firstVisitDone[i]) st.firstVisitHeap.push({firstRoundAfterSync(st, i), i, 0});
+            }
+        }
+    }
+
+    static long long firstRoundAfterSync(const EventQueueState &st, int i) {
+        return st.syncRound[i] + (i < st.syncIndex[i] ? 1 : 0);
+    }
+
+    // Visites reçues par i depuis sa dernière synchro, toutes pleines
+    static long long visitsSinceSync(const EventQueueState &st, int i) {
+        long long last = i < st.cursor ? st.round : st.round - 1;
+        return max(0LL, last - firstRoundAfterSync(st, i) + 1);
+    }
+
+    static void pushFinishKey(EventQueueState &st, int i, double unit) {
+        long long k = visitsToFinish(st.syncRemaining[i], unit);
+        st.finishHeap.push({firstRoundAfterSync(st, i) + k - 1, i, st.version[i]});
+    }
+
+    // Premier processus (dans l'ordre des visites) qui finira sur une visite pleine
+    bool nextFinish(EventQueueState &st, const Queue &q, long long &visitsBefore, int &index) {
+        while(!st.finishHeap.empty()) {
+            auto [round, i, version] = st.finishHeap.top();
+            if(version != st.version[i] || table.isFinished(q.firstSlot + i)) {
+                st.finishHeap.pop();
+                continue;
+            }
+            visitsBefore = (round - st.round) * q.liveCount + st.live.prefix(i) - st.live.prefix(st.cursor);
+            index = i;
+            return true;
+        }
+        return false;
+    }
+
+    // Applique d visites pleines à la suite sans toucher aux processus
+    void batchVisits(size_t qi, long long d, double unit, double &left, CycleStats &stats) {
+        if(d <= 0) return;
+        Queue &q = queues[qi];
+        EventQueueState &st = eventStates[qi];
+        long long rank = st.live.prefix(st.cursor) + d;
+        st.round += rank / q.liveCount;
+        st.cursor = st.live.kth(rank % q.liveCount);
+        applyFullVisits(qi, d, unit, left, stats);
+    }
+
+    // Comptes de d visites pleines : quota et demande restants décroissent
+    // sans changer de signe (soustractions exactes, une seule suffit), les
+    // totaux croissants reprennent les arrondis du pas à pas (repeatedSum)
+    void applyFullVisits(size_t qi, long long d, double unit, double &left, CycleStats &stats) {
+        Queue &q = queues[qi];
+        double amount = d * unit;
+        left -= amount;
+        if(demandSums[qi] >= amount) consumeDemand(qi, amount);
+        else for(long long k = 0; k < d; k++) consumeDemand(qi, unit);
+        q.totalAllocated = repeatedSum(q.totalAllocated, unit, d);
+        stats.totalAllocated = repeatedSum(stats.totalAllocated, unit, d);
+        stats.activeProcesses += d;
+    }
+
+    // Total alloué à i quand son restant vaut `remaining` : syncAllocated plus
+    // une addition de unit par visite pleine depuis la synchro
+    static double allocatedAt(const EventQueueState &st, int i, double remaining, double unit) {
+        return repeatedSum(st.syncAllocated[i], unit, llround((st.syncRemaining[i] - remaining) / unit));
+    }
+
+    // Première visite : début du processus et aging (RR uniquement)
+    void firstVisit(EventQueueState &st, Queue &q, int i, double allocatedBefore) {
+        if(st.firstVisitDone[i]) return;
+        st.firstVisitDone[i] = 1;
+        Process &p = q.processes[i];
+        if(!st.fifoMode && useAging && allocatedBefore == 0 && currentCycle > 1) {
+            p.waitTime += 1.0;
+            p.priority = max(1, (int)(p.basePriority * (1 + agingFactor * p.waitTime)));
+        }
+        if(p.startCycle == -1) p.startCycle = currentCycle;
+    }
+
+    // Visite explicite (fin de processus ou visite partielle), comme roundRobin()/fifo()
+    void eventVisit(size_t qi, int i, double remaining, double unit, double &left, CycleStats &stats) {
+        Queue &q = queues[qi];
+        EventQueueState &st = eventStates[qi];
+        size_t slot = q.firstSlot + i;
+        double allocated = allocatedAt(st, i, remaining, unit);
+        // Première visite éventuellement passée dans un bloc plus tôt dans le
+        // cycle : l'aging se juge sur l'allocation d'avant, celle de la synchro
+        firstVisit(st, q, i, st.syncAllocated[i]);
+
+        double alloc = min({remaining, unit, left});
+        remaining -= alloc;
+        allocated += alloc;
+        consumeDemand(qi, alloc);
+        left -= alloc;
+        q.totalAllocated += alloc;
+        stats.totalAllocated += alloc;
+        stats.activeProcesses++;
+
+        table.remaining[slot] = remaining;
+        table.allocated[slot] = allocated;
+        st.syncRemaining[i] = remaining;
+        st.syncAllocated[i] = allocated;
+
+        if(remaining <= 0) {
+            table.setFinished(slot);
+            q.processes[i].endCycle = currentCycle;
+            st.live.add(i, -1);
+            liveProcesses--;
+            stats.finishedProcesses++;
+            if(--q.liveCount == 0) clearDemand(qi);
+            if(st.fifoMode) st.remaining.set(i, numeric_limits<double>::infinity());
+        } else if(st.fifoMode) {
+            st.remaining.set(i, remaining);
+        }
+    }
+
+    void eventRoundRobin(size_t qi, double quota, double unit, CycleStats &stats) {
+        Queue &q = queues[qi];
+        EventQueueState &st = eventStates[qi];
+        double left = quota;
+
+        while(left > 0 && q.liveCount > 0) {
+            long long m = fullVisits(left, unit);
+            bool partial = left - m * unit > 0;
+
+            long long d;
+            int i;
+            bool finishing = nextFinish(st, q, d, i) && (d < m || (d == m && partial));
+            if(!finishing) {
+                batchVisits(qi, m, unit, left, stats);
+                if(!partial) break;
+                i = st.cursor;
+            } else {
+                batchVisits(qi, d, unit, left, stats);
+            }
+
+            // Visite explicite du processus sous le curseur
+            double remaining = st.syncRemaining[i] - unit * visitsSinceSync(st, i);
+            eventVisit(qi, i, remaining, unit, left, stats);
+            st.version[i]++;
+            if(!table.isFinished(q.firstSlot + i)) {
+                st.syncRound[i] = st.round;
+                st.syncIndex[i] = i + 1;
+                pushFinishKey(st, i, unit);
+            }
+            if(q.liveCount == 0) break;
+            int next = st.live.prefix(i + 1);
+            if(next >= q.liveCount) {
+                st.round++;
+                next = 0;
+            }
+            st.cursor = st.live.kth(next);
+        }
+
+        // Premières visites couvertes par les blocs de visites pleines
+        while(!st.firstVisitHeap.empty()) {
+            auto [round, i, version] = st.firstVisitHeap.top();
+            if(q.liveCount > 0 && make_pair(round, i) >= make_pair(st.round, st.cursor)) break;
+            st.firstVisitHeap.pop();
+            firstVisit(st, q, i, st.syncAllocated[i]);
+        }
+        if(q.liveCount > 0) q.rrIndex = st.cursor;
+    }
+
+    void eventFifo(size_t qi, double quota, double unit, CycleStats &stats) {
+        Queue &q = queues[qi];
+        EventQueueState &st = eventStates[qi];
+        double left = quota;
+        long long pos = 0;      // rang du prochain processus visité
+
+        while(left > 0 && pos < q.liveCount) {
+            long long m = fullVisits(left, unit);
+            long long limit = min<long long>(m, q.liveCount - pos);
+            int begin = st.live.kth(pos);
+            int end = limit > 0 ? st.live.kth(pos + limit - 1) + 1 : begin;
+
+            // Un processus dont le restant tient dans une visite finit ici
+            int f = st.remaining.findFirstAtMost(begin, end, unit);
+            if(f != -1) {
+                long long before = st.live.prefix(f) - pos;
+                st.remaining.add(begin, f, -unit);
+                applyFullVisits(qi, before, unit, left, stats);
+                pos += before;
+                eventVisit(qi, f, st.remaining.get(f), unit, left, stats);
+                continue;
+            }
+
+            st.remaining.add(begin, end, -unit);
+            applyFullVisits(qi, limit, unit, left, stats);
+            pos += limit;
+            if(left <= 0 || pos >= q.liveCount) break;
+
+            // Visite partielle : le quota restant est inférieur à unit
+            int i = st.live.kth(pos);
+            eventVisit(qi, i, st.remaining.get(i), unit, left, stats);
+            if(!table.isFinished(q.firstSlot + i)) pos++;
+        }
+
+        // Les processus de rang < pos ont été visités ce cycle
+        int lastVisited = pos > 0 ? st.live.kth(pos - 1) : -1;
+        while(st.pendingPos < st.pendingFirstVisit.size()
+              && st.pendingFirstVisit[st.pendingPos] <= lastVisited) {
+            int i = st.pendingFirstVisit[st.pendingPos++];
+            firstVisit(st, q, i, st.syncAllocated[i]);
+        }
+    }
+
+    // Arrivée en cours de run : le processus entre dans les index paresseux
+    // avec une synchro au point courant des visites
+    void admitEventState(size_t qi, int i, double unit) {
+        Queue &q = queues[qi];
+        EventQueueState &st = eventStates[qi];
+        size_t slot = q.firstSlot + i;
+        st.live.add(i, 1);
+        st.syncRemaining[i] = table.remaining[slot];
+        st.syncAllocated[i] = table.allocated[slot];
+        st.firstVisitDone[i] = 0;
+        if(st.fifoMode) {
+            st.remaining.set(i, st.syncRemaining[i]);
+            auto at = upper_bound(st.pendingFirstVisit.begin() + st.pendingPos, st.pendingFirstVisit.end(), i);
+            st.pendingFirstVisit.insert(at, i);
+            return;
+        }
+        if(q.liveCount == 1) st.cursor = i;     // file vide : le curseur repart de l'arrivant
+        st.syncRound[i] = st.round;
+        st.syncIndex[i] = st.cursor;
+        st.version[i]++;
+        pushFinishKey(st, i, unit);
+        st.firstVisitHeap.push({firstRoundAfterSync(st, i), i, 0});
+    }
+
+    // Recopie l'état paresseux dans la table et reconstruit les index vivants
+    void materializeEventStates(double unit) {
+        for(size_t qi = 0; qi < queues.size(); qi++) {
+            Queue &q = queues[qi];
+            EventQueueState &st = eventStates[qi];
+            for(int i = 0; i < (int)q.processes.size(); i++) {
+                size_t slot = q.firstSlot + i;
+                if(table.isFinished(slot)) continue;
+                double remaining = st.fifoMode ? st.remaining.get(i)
+                                               : st.syncRemaining[i] - unit * visitsSinceSync(st, i);
+                table.remaining[slot] = remaining;
+                table.allocated[slot] = allocatedAt(st, i, remaining, unit);
+            }
+            int cursor = q.rrIndex;
+            buildLiveIndex(q);
+            if(!st.fifoMode && q.liveCount > 0) q.rrIndex = cursor;
+        }
+        eventStates.clear();
+    }
+
+    // ---------- Index des processus vivants ----------
+    void buildLiveIndex(Queue &q) {
+        int n = q.processes.size();
+        q.nextLive.assign(n, -1);
+        q.prevLive.assign(n, -1);
+        q.headLive = -1;
+        q.liveCount = 0;
+        q.fair.initialized = false;         // WFQ, PRIO : états reconstruits à la prochaine passe
+        q.prio.initialized = false;
+
+        int last = -1;
+        for(int i = 0; i < n; i++) {
+            if(table.isFinished(q.firstSlot + i)) continue;
+            if(last == -1) q.headLive = i;
+            else {
+                q.nextLive[last] = i;
+                q.prevLive[i] = last;
+            }
+            last = i;
+            q.liveCount++;
+        }
+        if(q.headLive != -1) {
+            q.nextLive[last] = q.headLive;
+            q.prevLive[q.headLive] = last;
+        }
+
+        // Le curseur RR part du premier processus vivant à partir de rrIndex
+        int start = (n > 0 && q.rrIndex > 0) ? q.rrIndex % n : 0;
+        q.rrIndex = q.headLive;
+        for(int k = 0; k < n; k++) {
+            int i = (start + k) % n;
+            if(!table.isFinished(q.firstSlot + i)) { q.rrIndex = i; break; }
+        }
+    }
+
+    void unlinkFinished(Queue &q, int i) {
+        q.fair.remove(i);
+        q.prio.remove(i);
+        if(--q.liveCount == 0) {
+            q.headLive = -1;
+            q.rrIndex = -1;
+        } else {
+            int prev = q.prevLive[i], next = q.nextLive[i];
+            q.nextLive[prev] = next;
+            q.prevLive[next] = prev;
+            if(q.headLive == i) q.headLive = next;
+            if(q.rrIndex == i) q.rrIndex = next;
+        }
+    }
+
+    void releaseSlot(Queue &q, int i) {
+        q.processes[i].name.clear();
+        q.freeSlots.push_back(i);
+    }
+
+    // Agrandit la plage de la file qi de `extra` places libres, en fin de
+    // plage : les slots des files suivantes sont décalés (O(processus),
+    // amorti par le doublement), les indices locaux ne changent pas.
+    void growQueue(size_t qi, size_t extra) {
+        drainLogs();
+        ProcessTable grown;
+        size_t total = table.size() + extra;
+        grown.remaining.reserve(total);
+        grown.allocated.reserve(total);
+        grown.queueId.reserve(total);
+        grown.names.reserve(total);
+        vector<int> oldFirst(queues.size());
+        for(size_t k = 0; k < queues.size(); k++) {
+            Queue &q = queues[k];
+            oldFirst[k] = q.firstSlot;
+            int first = grown.size();
+            for(size_t i = 0; i < q.processes.size(); i++) grown.appendFrom(table, q.firstSlot + i, k);
+            if(k == qi) {
+                size_t n = q.processes.size();
+                Process unused{"", 0.0, 0.0, 0, true};
+                for(size_t e = 0; e < extra; e++) grown.append(unused, k);
+                q.processes.resize(n + extra, unused);
+                q.nextLive.resize(n + extra, -1);
+                q.prevLive.resize(n + extra, -1);
+                q.fair.grow(n + extra);
+                q.prio.grow(n + extra);
+                for(size_t e = n + extra; e-- > n;) q.freeSlots.push_back(e);
+            }
+            q.firstSlot = first;
+        }
+        for(auto &arrival : arrivals) {
+            int k = table.queueId[arrival.second];
+            arrival.second = queues[k].firstSlot + (arrival.second - oldFirst[k]);
+        }
+        table = move(grown);
+    }
+
+    // Insertion à sa place dans l'ordre des indices. Les vivants de la file
+    // sont exactement ses slots non terminés (les places libres et les
+    // arrivées à venir sont marquées terminées) : le prédécesseur est le
+    // dernier bit libre du masque avant i, trouvé mot par mot, sans parcourir
+    // la liste. Sans prédécesseur, l'arrivant devient la tête. Le curseur RR
+    // ne bouge pas : l'arrivant est servi à son tour dans la ronde.
+    void linkArrived(Queue &q, int i) {
+        q.fair.arrive(i);
+        q.prio.arrive(i);
+        if(q.liveCount++ == 0) {
+            q.headLive = q.rrIndex = i;
+            q.nextLive[i] = q.prevLive[i] = i;
+            return;
+        }
+        long before = table.lastUnfinished(q.firstSlot, q.firstSlot + i);
+        int prev = before >= 0 ? int(before - q.firstSlot) : q.prevLive[q.headLive];
+        if(before < 0) q.headLive = i;
+        int next = q.nextLive[prev];
+        q.nextLive[prev] = i;
+        q.prevLive[i] = prev;
+        q.nextLive[i] = next;
+        q.prevLive[next] = i;
+    }
+
+    // Demande recalculée sur toute la file ; en mode événementiel, les restants
+    // paresseux de la file sont d'abord recopiés dans la table
+    double exactDemand(size_t qi, double unit) {
+        const Queue &q = queues[qi];
+        size_t begin = q.firstSlot, end = q.firstSlot + q.processes.size();
+        if(!eventStates.empty()) {
+            EventQueueState &st = eventStates[qi];
+            for(size_t slot = begin; slot < end; slot++) {
+                if(table.isFinished(slot)) continue;
+                int i = slot - begin;
+                table.remaining[slot] = st.fifoMode ? st.remaining.get(i)
+                                                    : st.syncRemaining[i] - unit * visitsSinceSync(st, i);
+            }
+        }
+        return Kernels::sumUnfinished(table.remaining.data(), table.finishedMask.data(), begin, end);
+    }
+
+    // Somme vectorisée sur la fenêtre [premier vivant, dernier vivant] de la file
+    double liveDemand(const Queue &q) const {
+        if(q.liveCount == 0) return 0.0;
+        size_t begin = q.firstSlot + q.headLive;
+        size_t end = q.firstSlot + q.prevLive[q.headLive] + 1;
+        return Kernels::sumUnfinished(table.remaining.data(), table.finishedMask.data(), begin, end);
+    }
+
+    bool recordsWanted() const { return trace.isOpen() || captureGrants; }
+
+    void logAllocation(size_t qi, size_t slot, double alloc, bool& firstProcess, ostream &log, ostream &json) {
+        if(recordsWanted()) queueTrace[qi].push_back({currentCycle, (int32_t)qi, (int32_t)slot, alloc});
+        if(asyncLog) {
+            queueEvents[qi].push_back({alloc, (int32_t)slot, 0, LogEvent::Allocation});
+            return;
+        }
+        WRITE_TIMER(profiler, &log == &logFile);
+        const string &process = table.names[slot];
+        LogLayout::allocation(log, process, alloc);
+        JsonLayout::allocation(json, process, alloc, firstProcess);
+    }
+
+    void logFinished(size_t qi, size_t slot, int duration, ostream &log) {
+        if(asyncLog) {
+            queueEvents[qi].push_back({0.0, (int32_t)slot, duration, LogEvent::Finished});
+            return;
+        }
+        WRITE_TIMER(profiler, &log == &logFile);
+        LogLayout::finished(log, table.names[slot], duration);
+    }
+
+    // Écritures directes dans les fichiers : d'abord attendre l'écrivain
+    void drainLogs() {
+        if(asyncLog) asyncLog->flush();
+    }
+
+    // Processus fils d'un fork : seul le thread appelant existe et les
+    // fichiers sont ceux du parent. Pool et écrivain asynchrone sont
+    // abandonnés sans destruction (leurs threads n'existent pas ici), les
+    // journaux et la trace ne reçoivent plus rien.
+    void detachForkedChild() {
+        (void)pool.release();
+        (void)asyncLog.release();
+        logFile.setstate(ios::badbit);
+        jsonFile.setstate(ios::badbit);
+        trace.detach();
+        liveView = false;
+        profilePath.clear();
+    }
+
+    // Thread écrivain : met un lot d'événements en forme, puis une écriture par fichier
+    void writeLogEvents(const LogEvent *events, size_t n) {
+        for(size_t k = 0; k < n; k++) {
+            const LogEvent &e = events[k];
+            switch(e.kind) {
+            case LogEvent::CycleBegin:
+                LogLayout::cycleHeader(logBatch, e.id);
+                JsonLayout::beginCycle(jsonBatch, e.id, e.id == 1);
+                writerFirstQueue = true;
+                break;
+            case LogEvent::QueueBegin:
+                JsonLayout::beginQueue(jsonBatch, queues[e.id].name, e.value, writerFirstQueue);
+                LogLayout::queueHeader(logBatch, queues[e.id].name, queues[e.id].policy, e.value);
+                writerFirstQueue = false;
+                writerFirstProcess = true;
+                break;
+            case LogEvent::Allocation:
+                LogLayout::allocation(logBatch, table.names[e.id], e.value);
+                JsonLayout::allocation(jsonBatch, table.names[e.id], e.value, writerFirstProcess);
+                break;
+            case LogEvent::Finished:
+                LogLayout::finished(logBatch, table.names[e.id], e.extra);
+                break;
+            case LogEvent::QueueEnd:
+                JsonLayout::endQueue(jsonBatch);
+                break;
+            case LogEvent::CycleEnd:
+                JsonLayout::endCycle(jsonBatch);
+                LogLayout::cycleEnd(logBatch);
+                break;
+            }
+        }
+        logFile << logBatch.view();
+        jsonFile << jsonBatch.view();
+        logBatch.str("");
+        jsonBatch.str("");
+    }
+
+    void writeTraceHeader() {
+        vector<string> queueNames;
+        for(const auto &q : queues) queueNames.push_back(q.name);
+        trace.writeHeader(totalResource, timestamp, queueNames, table.names, table.queueId);
+        traceIds.assign(queues.size(), {});
+        for(size_t qi = 0; qi < queues.size(); qi++) {
+            for(size_t i = 0; i < queues[qi].processes.size(); i++) traceIds[qi].push_back(queues[qi].firstSlot + i);
+        }
+        nextTraceId = table.size();
+        tracedQueues = queues.size();
+    }
+
+    // Place du processus i de la file qi occupée par un nouveau venu : il
+    // recevra son propre identifiant de trace
+    void forgetTraceId(size_t qi, int i) {
+        if(!trace.hasHeader() || qi >= traceIds.size() || (size_t)i >= traceIds[qi].size()) return;
+        traceIds[qi][i] = -1;
+    }
+
+    // Enregistrement du moteur (processus désigné par son slot) -> enregistrement
+    // de la trace ; déclare les files et processus apparus depuis l'en-tête
+    TraceRecord tracedRecord(TraceRecord record) {
+        while(tracedQueues <= (size_t)record.queue) trace.declareQueue(queues[tracedQueues++].name);
+        if(record.process < 0) return record;
+        size_t qi = record.queue;
+        int i = record.process - queues[qi].firstSlot;
+        if(traceIds.size() <= qi) traceIds.resize(qi + 1);
+        vector<int32_t> &ids = traceIds[qi];
+        if(ids.size() <= (size_t)i) ids.resize(queues[qi].processes.size(), -1);
+        if(ids[i] < 0) {
+            ids[i] = nextTraceId++;
+            trace.declareProcess(qi, table.names[record.process]);
+        }
+        record.process = ids[i];
+        return record;
+    }
+
+    void showFinalReport() {
+        syncProcessViews();
+        Display::clearScreen();
+        Display::printBanner(cout);
+        Display::printHeader(cout, "🏆 RAPPORT FINAL DE SIMULATION");
+
+        cout << "\n\033[1;32m✅ Simulation terminée avec succès!\033[0m\n";
+        cout << "   📊 Cycles totaux: \033[1;33m" << currentCycle << "\033[0m\n\n";
+
+        Display::printSeparator(cout, "═");
+        cout << "\n\033[1;36m📈 STATISTIQUES GLOBALES PAR FILE\033[0m\n\n";
+
+        for(const auto& q : queues) {
+            cout << "  " << q.emoji << " " << q.color << q.name << "\033[0m\n";
+            cout << "     ├─ Ressources allouées : " << fixed << setprecision(2) 
+                 << q.totalAllocated << " unités\n";
+            
+            int completedCount = 0;
+            double avgDuration = 0;
+            double avgResponse = 0;
+            for(const auto& p : q.processes) {
+                if(p.finished) {
+                    completedCount++;
+                    avgDuration += (p.endCycle - p.startCycle + 1);
+                    avgResponse += p.responseCycles();
+                }
+            }
+            avgDuration /= max(1, completedCount);
+            avgResponse /= max(1, completedCount);
+            
+            cout << "     ├─ Processus terminés  : " << completedCount << "/" 
+                 << q.processes.size() << "\n";
+            cout << "     ├─ Durée moyenne       : " << fixed << setprecision(1) 
+                 << avgDuration << " cycles\n";
+            cout << "     └─ Réponse moyenne     : " << fixed << setprecision(1) 
+                 << avgResponse << " cycles (depuis l'arrivée)\n\n";
+        }
+
+        Display::printSeparator(cout, "═");
+        cout << "\n\033[1;35m🔍 DÉTAILS PAR PROCESSUS\033[0m\n\n";
+
+        for(const auto& q : queues) {
+            cout << "  " << q.color << "▸ " << q.name << "\033[0m\n";
+            for(const auto& p : q.processes) {
+                cout << "    • " << setw(12) << left << p.name 
+                     << " │ Demande: " << setw(6) << right << fixed << setprecision(1) << p.demand 
+                     << " │ Alloué: " << setw(6) << p.allocated 
+                     << " │ Début: C" << setw(2) << p.startCycle 
+                     << " │ Fin: C" << setw(2) << p.endCycle 
+                     << " │ Durée: " << (p.endCycle - p.startCycle + 1) << " cycles"
+                     << " │ Arrivée: C" << setw(2) << max(p.arrivalCycle, 1)
+                     << " │ Réponse: " << p.responseCycles() << " cycles\n";
+            }
+            cout << "\n";
+        }
+
+#if defined(SIM4_PROFILE)
+        Display::printSeparator(cout, "═");
+        cout << "\n\033[1;36m⏱️  PROFIL DES PHASES\033[0m\n\n";
+        profiler.report(cout);
+        cout << "\n";
+#endif
+
+        Display::printSeparator(cout, "═");
+        cout << "\n\033[1;33m💾 FICHIERS GÉNÉRÉS\033[0m\n";
+        cout << "  ✓ allocation_log.txt  (journal détaillé)\n";
+        cout << "  ✓ allocation_data.json (données structurées)\n";
+        if(writeProfile()) cout << "  ✓ " << profilePath << " (profil des phases)\n";
+        cout << "\n";
+
+        drainLogs();
+        logFile << "\n═══════════════════════════════════════\n";
+        logFile << "RESULTAT FINAL\n";
+        logFile << "═══════════════════════════════════════\n";
+        logFile << "Cycles totaux: " << currentCycle << "\n";
+        logFile << "Tous les processus terminés avec succès.\n";
+    }
+};
+
+// ==================== POLITIQUES ====================
+// Une politique est un type : un nom et une passe d'allocation sur une file.
+// Pour en ajouter une sans modifier ResourceAllocator :
+//
+//   struct ShortestFirstPolicy {
+//       static constexpr const char *name = "SJF";
+//       static void allocate(ResourceAllocator::QueuePass &pass, double quota, double unit) {
+//           ...  // pass.liveCount(), pass.remaining(i), pass.grant(i, montant)
+//       }
+//   };
+//   static const int shortestFirst = PolicyRegistry::add<ShortestFirstPolicy>();
+//
+// Les files ajoutées ensuite avec policy = "SJF" passent par le noyau
+// allocateGroup<ShortestFirstPolicy>. Le moteur événementiel ne couvre que
+// RR et FIFO : avec une autre politique, il repasse en cycle par cycle.
+
+// rrIndex désigne toujours le prochain processus vivant : les terminés
+// ne sont plus jamais visités.
+struct RoundRobinPolicy {
+    static constexpr const char *name = "RR";
+
+    static void allocate(ResourceAllocator::QueuePass &pass, double quota, double unit) {
+        while(quota > 0 && pass.liveCount() > 0) {
+            int i = pass.cursor();
+            pass.age(i);
+            double alloc = min({pass.remaining(i), unit, quota});
+            quota -= alloc;
+            pass.setCursor(pass.nextLive(i));
+            pass.grant(i, alloc);
+        }
+    }
+};
+
+struct FifoPolicy {
+    static constexpr const char *name = "FIFO";
+
+    static void allocate(ResourceAllocator::QueuePass &pass, double quota, double unit) {
+        int visits = pass.liveCount();
+        int i = pass.firstLive();
+        for(int k = 0; k < visits; k++) {
+            if(quota <= 0) break;
+            int next = pass.nextLive(i);
+            double alloc = min({pass.remaining(i), unit, quota});
+            quota -= alloc;
+            pass.grant(i, alloc);
+            i = next;
+        }
+    }
+};
+
+// WF2Q+ : tranches d'au plus `unit`, données au processus éligible (début
+// virtuel <= temps virtuel de la file) de plus petite fin virtuelle
+// (début + tranche / poids). Le poids est la priorité du processus (vieillie
+// comme en RR). Chaque décision coûte O(log n) ; l'état (Queue::fair) est
+// conservé d'un cycle à l'autre, une tranche coupée par le quota n'avance
+// l'étiquette que de ce qui a été servi.
+struct WeightedFairPolicy {
+    static constexpr const char *name = "WFQ";
+
+    static void allocate(ResourceAllocator::QueuePass &pass, double quota, double unit) {
+        FairQueueState &fair = pass.fairState();
+        if(!fair.initialized) {
+            fair.reset(pass.size());
+            for(int i = pass.firstLive(), k = 0; k < pass.liveCount(); i = pass.nextLive(i), k++) {
+                admit(pass, fair, i, unit);
+            }
+        }
+        for(int i : fair.arrived) {
+            if(pass.live(i) && fair.weight[i] == 0) admit(pass, fair, i, unit);
+        }
+        fair.arrived.clear();
+
+        while(quota > 0 && pass.liveCount() > 0) {
+            while(!fair.waiting.empty() && fair.waiting.topKey() <= fair.virtualTime) {
+                int i = fair.waiting.pop();
+                fair.eligible.push(i, finishTag(pass, fair, i, unit));
+            }
+            if(fair.eligible.empty()) {
+                fair.virtualTime = fair.waiting.topKey();   // aucun éligible : le temps virtuel rattrape
+                continue;
+            }
+            int i = fair.eligible.pop();
+            pass.age(i);
+            double alloc = min({pass.remaining(i), unit, quota});
+            quota -= alloc;
+            fair.virtualTime += alloc / fair.weightSum;
+            fair.start[i] += alloc / fair.weight[i];
+            if(pass.grant(i, alloc)) continue;              // terminé : retiré par unlinkFinished
+
+            double w = pass.process(i).priority;            // l'aging a pu changer le poids
+            fair.weightSum += w - fair.weight[i];
+            fair.weight[i] = w;
+            schedule(pass, fair, i, unit);
+        }
+    }
+
+private:
+    static double finishTag(ResourceAllocator::QueuePass &pass, const FairQueueState &fair, int i, double unit) {
+        return fair.start[i] + min(pass.remaining(i), unit) / fair.weight[i];
+    }
+
+    static void admit(ResourceAllocator::QueuePass &pass, FairQueueState &fair, int i, double unit) {
+        fair.start[i] = fair.virtualTime;
+        fair.weight[i] = pass.process(i).priority;
+        fair.weightSum += fair.weight[i];
+        schedule(pass, fair, i, unit);
+    }
+
+    static void schedule(ResourceAllocator::QueuePass &pass, FairQueueState &fair, int i, double unit) {
+        if(fair.start[i] <= fair.virtualTime) fair.eligible.push(i, finishTag(pass, fair, i, unit));
+        else fair.waiting.push(i, fair.start[i]);
+    }
+};
+
+// Priorité avec vieillissement paresseux : la passe sert d'abord le processus
+// de plus forte priorité effective (base + taux × cycles depuis son dernier
+// service, taux = agingFactor, 0 sans aging), par tranches d'au plus `unit`.
+// Un processus servi repart de sa priorité de base. Seuls les processus
+// servis sont touchés : O(log n) par décision, rien pour les autres.
+struct PriorityPolicy {
+    static constexpr const char *name = "PRIO";
+
+    static void allocate(ResourceAllocator::QueuePass &pass, double quota, double unit) {
+        PriorityQueueState &prio = pass.priorityState();
+        double rate = pass.agingRate();
+        if(!prio.initialized || prio.rate != rate) {
+            prio.reset(pass.size(), rate);
+            for(int i = pass.firstLive(), k = 0; k < pass.liveCount(); i = pass.nextLive(i), k++) {
+                prio.lastService[i] = pass.cycle();
+                schedule(pass, prio, i);
+            }
+        }
+        for(int i : prio.arrived) {
+            if(!pass.live(i) || prio.heap.contains(i)) continue;
+            prio.lastService[i] = pass.cycle();
+            schedule(pass, prio, i);
+        }
+        prio.arrived.clear();
+
+        while(quota > 0 && !prio.heap.empty()) {
+            int i = prio.heap.pop();
+            double alloc = min({pass.remaining(i), unit, quota});
+            quota -= alloc;
+            prio.lastService[i] = pass.cycle();
+            if(!pass.grant(i, alloc)) schedule(pass, prio, i);
+        }
+    }
+
+private:
+    static void schedule(ResourceAllocator::QueuePass &pass, PriorityQueueState &prio, int i) {
+        double key = prio.rate * prio.lastService[i] - pass.process(i).basePriority;
+        prio.heap.push(i, {key, prio.sequence++});
+    }
+};
+
+vector<PolicyEntry> &PolicyRegistry::entries() {
+    static vector<PolicyEntry> table = {
+        {RoundRobinPolicy::name, &ResourceAllocator::allocateGroup<RoundRobinPolicy>, true},
+        {FifoPolicy::name, &ResourceAllocator::allocateGroup<FifoPolicy>, true},
+    };
+    return table;
+}
+
+// Enregistre (ou remplace) une politique ; retourne son identifiant
+template<class Policy>
+int PolicyRegistry::add() {
+    PolicyEntry entry = {Policy::name, &ResourceAllocator::allocateGroup<Policy>, false};
+    int id = find(entry.name);
+    if(id >= 0) {
+        entries()[id] = entry;
+        return id;
+    }
+    entries().push_back(entry);
+    return entries().size() - 1;
+}
+
+static const int weightedFair = PolicyRegistry::add<WeightedFairPolicy>();
+static const int lazyPriority = PolicyRegistry::add<PriorityPolicy>();
+
+// ==================== SCÉNARIO PAR DÉFAUT ====================
+// Configuration des files avec couleurs et emojis
+vector<Queue> defaultQueues() {
+    Queue q1 = {
+        "File 1 (VVIP)", 
+        {
+            {"P1", 50, 50, 1, false, 0.0, -1, -1, 0.0, 1}, 
+            {"P2", 30, 30, 1, false, 0.0, -1, -1, 0.0, 1}
+        }, 
+        0.5, 
+        "RR",
+        0,
+        0.0,
+        0.0,
+        "\033[1;31m",  // Rouge
+        "🔴"
+    };
+
+    Queue q2 = {
+        "File 2 (VIP)", 
+        {
+            {"P3", 60, 60, 2, false, 0.0, -1, -1, 0.0, 2}, 
+            {"P4", 40, 40, 2, false, 0.0, -1, -1, 0.0, 2}
+        }, 
+        0.3, 
+        "RR",
+        0,
+        0.0,
+        0.0,
         "\033[1;33m",  // Jaune
         "🟠"
     };
 
-    Queue q3 = {
-        "File 3 (CLASSIC)", 
-        {
-            {"P5", 80, 80, 3, false, 0.0, -1, -1, 0.0, 3}, 
-            {"P6", 20, 20, 3, false, 0.0, -1, -1, 0.0, 3}
-        }, 
-        0.2, 
-        "FIFO",
-        0,
-        0.0,
-        0.0,
-        "\033[1;32m",  // Vert
-        "🟢"
+    Queue q3 = {
+        "File 3 (CLASSIC)", 
+        {
+            {"P5", 80, 80, 3, false, 0.0, -1, -1, 0.0, 3}, 
+            {"P6", 20, 20, 3, false, 0.0, -1, -1, 0.0, 3}
+        }, 
+        0.2, 
+        "FIFO",
+        0,
+        0.0,
+        0.0,
+        "\033[1;32m",  // Vert
+        "🟢"
+    };
+
+    return {q1, q2, q3};
+}
+
+// ==================== CHARGEMENT DES SCÉNARIOS ====================
+// CSV, un enregistrement par ligne (# en début de ligne : commentaire ; champ
+// entre guillemets possible, "" pour un guillemet) :
+//   group,<nom>,<poids>[,<groupe parent>]             déclaré avant ses enfants
+//   queue,<nom>,<poids>,<politique>[,<couleur>[,<groupe>]]
+//   process,<nom>,<demande>[,<priorité>[,<arrivée>[,<besoins>]]]   rattaché à la dernière file
+// JSON :
+//   {"groups": [{"name": "Locataire A", "weight": 2}, {"name": "Équipe 1", "weight": 1, "parent": "Locataire A"}],
+//    "queues": [{"name": "File 1", "weight": 0.5, "policy": "RR", "color": "rouge", "group": "Équipe 1",
+//                "processes": [{"name": "P1", "demand": 50, "priority": 1, "arrival": 4, "need": [1, 4]}]}]}
+// L'arrivée (cycle d'admission, 0 par défaut) rejoue une trace d'arrivées.
+// Les besoins (CSV : « 1;4 ») donnent la consommation de chaque ressource par
+// unité allouée, dans l'ordre de --resources ; absents : 1 sur la première.
+// Sans groupe, toutes les files sont sous la racine (quotas à plat).
+// Couleurs : rouge, jaune, vert, bleu, magenta, cyan (à tour de rôle par défaut).
+// Le fichier est projeté en mémoire et parcouru une seule fois : les champs sont
+// lus en place (string_view, from_chars) et chaque processus est rangé
+// directement dans l'allocateur, sans objet intermédiaire par ligne. En cas
+// d'erreur, l'allocateur contient un scénario partiel et doit être abandonné.
+struct LoadStats {
+    size_t bytes = 0;
+    size_t rows = 0;            // groupes + files + processus
+    size_t queues = 0;
+    size_t processes = 0;
+    double seconds = 0.0;
+};
+
+struct QueueStyle {
+    const char *name;
+    const char *color;
+    const char *emoji;
+};
+
+const QueueStyle queueStyles[] = {
+    {"rouge", "\033[1;31m", "🔴"}, {"jaune", "\033[1;33m", "🟠"}, {"vert", "\033[1;32m", "🟢"},
+    {"bleu", "\033[1;34m", "🔵"}, {"magenta", "\033[1;35m", "🟣"}, {"cyan", "\033[1;36m", "⚪"},
+};
+
+// Style nommé ; nom vide : style suivant du cycle. nullptr si inconnu.
+const QueueStyle *findQueueStyle(string_view name, size_t queueIndex) {
+    const size_t count = sizeof(queueStyles) / sizeof(queueStyles[0]);
+    if(name.empty()) return &queueStyles[queueIndex % count];
+    for(const auto &style : queueStyles) {
+        if(name == style.name) return &style;
+    }
+    return nullptr;
+}
+
+bool parseWorkloadNumber(string_view text, double &value) {
+    const char *end = text.data() + text.size();
+    auto result = from_chars(text.data(), end, value);
+    return result.ec == errc() && result.ptr == end && isfinite(value);
+}
+
+bool parseWorkloadInteger(string_view text, int &value) {
+    const char *end = text.data() + text.size();
+    auto result = from_chars(text.data(), end, value);
+    return result.ec == errc() && result.ptr == end;
+}
+
+// Besoins séparés par « ; » : au plus MaxResources valeurs positives ou
+// nulles, pas toutes nulles
+bool parseResourceVector(string_view text, ResourceVector &need) {
+    need = {};
+    size_t count = 0;
+    while(true) {
+        size_t stop = min(text.find(';'), text.size());
+        if(count == MaxResources || !parseWorkloadNumber(text.substr(0, stop), need[count]) || need[count] < 0) {
+            return false;
+        }
+        count++;
+        if(stop == text.size()) break;
+        text.remove_prefix(stop + 1);
+    }
+    return !need.empty();
+}
+
+// --resources : « nom=capacité » séparés par des virgules (cpu=9,mem=18)
+bool parseResourceSpec(const string &text, vector<string> &names, vector<double> &capacities,
+                       string &error) {
+    names.clear();
+    capacities.clear();
+    stringstream list(text);
+    string item;
+    while(getline(list, item, ',')) {
+        size_t eq = item.find('=');
+        double capacity;
+        if(eq == string::npos || eq == 0 || !parseWorkloadNumber(string_view(item).substr(eq + 1), capacity)) {
+            error = "ressource invalide « " + item + " » (nom=capacité attendu)";
+            return false;
+        }
+        names.push_back(item.substr(0, eq));
+        capacities.push_back(capacity);
+    }
+    if(names.empty()) error = "aucune ressource";
+    return !names.empty();
+}
+
+// Découpe une ligne en champs (au plus fields.size(), les suivants sont
+// ignorés). Un champ entre guillemets contenant "" est recopié dans scratch ;
+// les autres restent des vues sur la ligne.
+size_t splitCsvLine(string_view line, array<string_view, 6> &fields, array<string, 6> &scratch) {
+    size_t count = 0;
+    size_t pos = 0;
+    while(count < fields.size()) {
+        while(pos < line.size() && (line[pos] == ' ' || line[pos] == '\t')) pos++;
+        string_view field;
+        if(pos < line.size() && line[pos] == '"') {
+            size_t start = ++pos;
+            bool doubled = false;
+            while(pos < line.size()) {
+                if(line[pos] != '"') { pos++; continue; }
+                if(pos + 1 < line.size() && line[pos + 1] == '"') { doubled = true; pos += 2; continue; }
+                break;
+            }
+            field = line.substr(start, pos - start);
+            if(doubled) {
+                scratch[count].clear();
+                for(size_t k = 0; k < field.size(); k++) {
+                    scratch[count] += field[k];
+                    if(field[k] == '"') k++;
+                }
+                field = scratch[count];
+            }
+            pos = min(line.find(',', pos), line.size());
+        } else {
+            size_t stop = min(line.find(',', pos), line.size());
+            field = line.substr(pos, stop - pos);
+            while(!field.empty() && (field.back() == ' ' || field.back() == '\t')) field.remove_suffix(1);
+            pos = stop;
+        }
+        fields[count++] = field;
+        if(pos >= line.size()) break;
+        pos++;      // virgule
+    }
+    return count;
+}
+
+bool loadCsvWorkload(const char *data, size_t size, ResourceAllocator &allocator,
+                     LoadStats &stats, string &error) {
+    array<string_view, 6> fields;
+    array<string, 6> scratch;
+    bool queueOpen = false;
+    size_t lineNumber = 0;
+    auto fail = [&](const string &message) {
+        error = "ligne " + to_string(lineNumber) + ": " + message;
+        return false;
+    };
+
+    const char *p = data, *end = data + size;
+    while(p < end) {
+        const char *eol = static_cast<const char *>(memchr(p, '\n', end - p));
+        if(!eol) eol = end;
+        string_view line(p, eol - p);
+        p = eol < end ? eol + 1 : end;
+        lineNumber++;
+        if(!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        size_t first = line.find_first_not_of(" \t");
+        if(first == string_view::npos || line[first] == '#') continue;
+
+        size_t n = splitCsvLine(line, fields, scratch);
+        if(fields[0] == "queue") {
+            if(n < 4) return fail("file : nom, poids et politique attendus");
+            double weight;
+            if(fields[1].empty()) return fail("file sans nom");
+            if(!parseWorkloadNumber(fields[2], weight) || weight < 0) {
+                return fail("poids invalide « " + string(fields[2]) + " »");
+            }
+            if(PolicyRegistry::find(fields[3]) < 0) return fail("politique inconnue " + string(fields[3]));
+            const QueueStyle *style = findQueueStyle(n > 4 ? fields[4] : string_view(), stats.queues);
+            if(!style) return fail("couleur inconnue " + string(fields[4]));
+            int group = n > 5 && !fields[5].empty() ? allocator.findGroup(fields[5]) : -1;
+            if(n > 5 && !fields[5].empty() && group < 0) return fail("groupe inconnu " + string(fields[5]));
+
+            if(queueOpen) allocator.closeQueue();
+            Queue &q = allocator.openQueue();
+            q.name = fields[1];
+            q.weight = weight;
+            q.policy = fields[3];
+            q.color = style->color;
+            q.emoji = style->emoji;
+            q.group = group;
+            queueOpen = true;
+            stats.queues++;
+        } else if(fields[0] == "group") {
+            if(n < 3) return fail("groupe : nom et poids attendus");
+            double weight;
+            if(fields[1].empty()) return fail("groupe sans nom");
+            if(allocator.findGroup(fields[1]) >= 0) return fail("groupe en double " + string(fields[1]));
+            if(!parseWorkloadNumber(fields[2], weight) || weight < 0) {
+                return fail("poids invalide « " + string(fields[2]) + " »");
+            }
+            int parent = n > 3 && !fields[3].empty() ? allocator.findGroup(fields[3]) : -1;
+            if(n > 3 && !fields[3].empty() && parent < 0) return fail("groupe parent inconnu " + string(fields[3]));
+            allocator.addGroup(fields[1], weight, parent);
+            stats.rows++;
+            continue;
+        } else if(fields[0] == "process") {
+            if(!queueOpen) return fail("processus avant toute file");
+            if(n < 3) return fail("processus : nom et demande attendus");
+            double demand;
+            int priority = 1;
+            int arrival = 0;
+            if(fields[1].empty()) return fail("processus sans nom");
+            if(!parseWorkloadNumber(fields[2], demand) || demand <= 0) {
+                return fail("demande invalide « " + string(fields[2]) + " »");
+            }
+            if(n > 3 && !fields[3].empty() && (!parseWorkloadInteger(fields[3], priority) || priority < 1)) {
+                return fail("priorité invalide « " + string(fields[3]) + " »");
+            }
+            if(n > 4 && !fields[4].empty() && (!parseWorkloadInteger(fields[4], arrival) || arrival < 0)) {
+                return fail("arrivée invalide « " + string(fields[4]) + " »");
+            }
+            ResourceVector need;
+            if(n > 5 && !fields[5].empty() && !parseResourceVector(fields[5], need)) {
+                return fail("besoins invalides « " + string(fields[5]) + " »");
+            }
+            allocator.appendProcess(fields[1], demand, priority, arrival, need);
+            stats.processes++;
+        } else {
+            return fail("enregistrement inconnu « " + string(fields[0]) + " » (group, queue ou process)");
+        }
+        stats.rows++;
+    }
+    if(queueOpen) allocator.closeQueue();
+    return true;
+}
+
+// Analyseur JSON à la volée : les objets sont parcourus membre par membre et
+// les clés inconnues sautées. Une chaîne sans échappement est une vue sur le
+// fichier ; sinon elle est décodée dans scratch (valable jusqu'à la suivante).
+class JsonWorkloadReader {
+public:
+    JsonWorkloadReader(const char *data, size_t size, ResourceAllocator &target, LoadStats &loadStats)
+        : begin(data), p(data), end(data + size), allocator(target), stats(loadStats) {}
+
+    bool read(string &error) {
+        bool ok = readObject([&](string_view key) {
+            if(key == "groups") return readArray([&] { return readGroup(); });
+            if(key == "queues") return readArray([&] { return readQueue(); });
+            return skipValue(0);
+        });
+        if(ok) {
+            skipSpace();
+            if(p < end) ok = fail("contenu après l'objet racine");
+        }
+        if(!ok) error = message;
+        return ok;
+    }
+
+private:
+    const char *begin;
+    const char *p;
+    const char *end;
+    ResourceAllocator &allocator;
+    LoadStats &stats;
+    string scratch;
+    string processName;
+    string message;
+
+    bool fail(const string &text) {
+        message = "octet " + to_string(p - begin) + ": " + text;
+        return false;
+    }
+
+    void skipSpace() {
+        while(p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) p++;
+    }
+
+    bool expect(char c) {
+        skipSpace();
+        if(p < end && *p == c) { p++; return true; }
+        return fail(string("'") + c + "' attendu");
+    }
+
+    bool accept(char c) {
+        skipSpace();
+        if(p < end && *p == c) { p++; return true; }
+        return false;
+    }
+
+    // onMember(clé) lit la valeur du membre ; la clé n'est valable qu'avant
+    template<class OnMember> bool readObject(OnMember onMember) {
+        if(!expect('{')) return false;
+        if(accept('}')) return true;
+        do {
+            string_view key;
+            if(!readString(key) || !expect(':') || !onMember(key)) return false;
+        } while(accept(','));
+        return expect('}');
+    }
+
+    template<class OnElement> bool readArray(OnElement onElement) {
+        if(!expect('[')) return false;
+        if(accept(']')) return true;
+        do {
+            if(!onElement()) return false;
+        } while(accept(','));
+        return expect(']');
+    }
+
+    bool readString(string_view &text) {
+        if(!expect('"')) return false;
+        const char *start = p;
+        while(p < end && *p != '"' && *p != '\\') p++;
+        if(p < end && *p == '"') {
+            text = string_view(start, p++ - start);
+            return true;
+        }
+        scratch.assign(start, p);
+        while(p < end && *p != '"') {
+            if(*p != '\\') { scratch += *p++; continue; }
+            if(++p == end) break;
+            char c = *p++;
+            switch(c) {
+                case 'n': scratch += '\n'; break;
+                case 't': scratch += '\t'; break;
+                case 'r': scratch += '\r'; break;
+                case 'b': scratch += '\b'; break;
+                case 'f': scratch += '\f'; break;
+                case 'u': {
+                    uint32_t code = 0;
+                    if(!readHex(code)) return fail("séquence \\u invalide");
+                    if(code >= 0xD800 && code < 0xDC00 && end - p >= 2 && p[0] == '\\' && p[1] == 'u') {
+                        p += 2;
+                        uint32_t low = 0;
+                        if(!readHex(low) || low < 0xDC00 || low >= 0xE000) return fail("paire UTF-16 invalide");
+                        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    appendUtf8(code);
+                    break;
+                }
+                default: scratch += c; break;       // \" \\ \/
+            }
+        }
+        if(p == end) return fail("chaîne non terminée");
+        p++;
+        text = scratch;
+        return true;
+    }
+
+    bool readHex(uint32_t &code) {
+        if(end - p < 4) return false;
+        auto result = from_chars(p, p + 4, code, 16);
+        if(result.ptr != p + 4) return false;
+        p += 4;
+        return true;
+    }
+
+    void appendUtf8(uint32_t code) {
+        if(code < 0x80) {
+            scratch += char(code);
+        } else if(code < 0x800) {
+            scratch += char(0xC0 | (code >> 6));
+            scratch += char(0x80 | (code & 0x3F));
+        } else if(code < 0x10000) {
+            scratch += char(0xE0 | (code >> 12));
+            scratch += char(0x80 | ((code >> 6) & 0x3F));
+            scratch += char(0x80 | (code & 0x3F));
+        } else {
+            scratch += char(0xF0 | (code >> 18));
+            scratch += char(0x80 | ((code >> 12) & 0x3F));
+            scratch += char(0x80 | ((code >> 6) & 0x3F));
+            scratch += char(0x80 | (code & 0x3F));
+        }
+    }
+
+    bool readNumber(double &value) {
+        skipSpace();
+        auto result = from_chars(p, end, value);
+        if(result.ec != errc() || !isfinite(value)) return fail("nombre attendu");
+        p = result.ptr;
+        return true;
+    }
+
+    bool skipValue(int depth) {
+        if(depth > 64) return fail("imbrication trop profonde");
+        skipSpace();
+        if(p == end) return fail("valeur attendue");
+        if(*p == '"') { string_view text; return readString(text); }
+        if(*p == '{') return readObject([&](string_view) { return skipValue(depth + 1); });
+        if(*p == '[') return readArray([&] { return skipValue(depth + 1); });
+        for(const char *word : {"true", "false", "null"}) {
+            size_t n = strlen(word);
+            if((size_t)(end - p) >= n && memcmp(p, word, n) == 0) { p += n; return true; }
+        }
+        double ignored;
+        return readNumber(ignored);
+    }
+
+    // Groupe : déclaré avant les groupes et files qui le nomment
+    bool readGroup() {
+        string name, parentName;
+        double weight = -1.0;
+        bool ok = readObject([&](string_view key) {
+            string_view text;
+            if(key == "name") { if(!readString(text)) return false; name = text; return true; }
+            if(key == "parent") { if(!readString(text)) return false; parentName = text; return true; }
+            if(key == "weight") return readNumber(weight);
+            return skipValue(0);
+        });
+        if(!ok) return false;
+        if(name.empty()) return fail("groupe sans nom");
+        if(allocator.findGroup(name) >= 0) return fail("groupe en double " + name);
+        if(weight < 0) return fail("poids manquant ou invalide pour " + name);
+        int parent = parentName.empty() ? -1 : allocator.findGroup(parentName);
+        if(!parentName.empty() && parent < 0) return fail("groupe parent inconnu " + parentName);
+        allocator.addGroup(name, weight, parent);
+        stats.rows++;
+        return true;
+    }
+
+    bool readQueue() {
+        Queue &q = allocator.openQueue();
+        bool hasWeight = false;
+        string styleName, groupName;
+        bool ok = readObject([&](string_view key) {
+            string_view text;
+            if(key == "name") { if(!readString(text)) return false; q.name = text; return true; }
+            if(key == "policy") { if(!readString(text)) return false; q.policy = text; return true; }
+            if(key == "color") { if(!readString(text)) return false; styleName = text; return true; }
+            if(key == "group") { if(!readString(text)) return false; groupName = text; return true; }
+            if(key == "weight") { hasWeight = true; return readNumber(q.weight); }
+            if(key == "processes") return readArray([&] { return readProcess(); });
+            return skipValue(0);
+        });
+        if(!ok) return false;
+        if(q.name.empty()) return fail("file sans nom");
+        if(!hasWeight || q.weight < 0) return fail("poids manquant ou invalide pour " + q.name);
+        if(PolicyRegistry::find(q.policy) < 0) return fail("politique inconnue « " + q.policy + " » pour " + q.name);
+        const QueueStyle *style = findQueueStyle(styleName, stats.queues);
+        if(!style) return fail("couleur inconnue " + styleName);
+        q.color = style->color;
+        q.emoji = style->emoji;
+        q.group = groupName.empty() ? -1 : allocator.findGroup(groupName);
+        if(!groupName.empty() && q.group < 0) return fail("groupe inconnu « " + groupName + " » pour " + q.name);
+        allocator.closeQueue();
+        stats.queues++;
+        stats.rows++;
+        return true;
+    }
+
+    bool readProcess() {
+        processName.clear();
+        double demand = 0.0;
+        double priority = 1.0;
+        double arrival = 0.0;
+        ResourceVector need;
+        size_t needCount = 0;
+        bool badNeed = false;
+        bool ok = readObject([&](string_view key) {
+            string_view text;
+            if(key == "name") { if(!readString(text)) return false; processName = text; return true; }
+            if(key == "demand") return readNumber(demand);
+            if(key == "priority") return readNumber(priority);
+            if(key == "arrival") return readNumber(arrival);
+            if(key == "need") {
+                need = {};
+                needCount = 0;
+                return readArray([&] {
+                    double value;
+                    if(!readNumber(value)) return false;
+                    if(needCount == MaxResources || value < 0) badNeed = true;
+                    else need[needCount++] = value;
+                    return true;
+                });
+            }
+            return skipValue(0);
+        });
+        if(!ok) return false;
+        if(badNeed || (needCount > 0 && need.empty())) return fail("besoins invalides pour " + processName);
+        if(processName.empty()) return fail("processus sans nom");
+        if(demand <= 0) return fail("demande invalide pour " + processName);
+        if(priority < 1 || priority != floor(priority) || priority > numeric_limits<int>::max()) {
+            return fail("priorité invalide pour " + processName);
+        }
+        if(arrival < 0 || arrival != floor(arrival) || arrival > numeric_limits<int>::max()) {
+            return fail("arrivée invalide pour " + processName);
+        }
+        allocator.appendProcess(processName, demand, (int)priority, (int)arrival, need);
+        stats.processes++;
+        stats.rows++;
+        return true;
+    }
+};
+
+// Format détecté au premier caractère utile : '{' pour JSON, CSV sinon
+bool loadWorkload(const string &path, ResourceAllocator &allocator, LoadStats &stats, string &error) {
+    auto start = chrono::steady_clock::now();
+    MappedFile file;
+    if(!file.open(path, error)) return false;
+    const char *data = file.data();
+    size_t size = file.size();
+    if(size >= 3 && memcmp(data, "\xEF\xBB\xBF", 3) == 0) { data += 3; size -= 3; }   // BOM UTF-8
+    stats.bytes = file.size();
+
+    size_t first = 0;
+    while(first < size && isspace((unsigned char)data[first])) first++;
+    bool ok = first < size && data[first] == '{'
+              ? JsonWorkloadReader(data, size, allocator, stats).read(error)
+              : loadCsvWorkload(data, size, allocator, stats, error);
+    if(ok && stats.queues == 0) {
+        error = "aucune file dans " + path;
+        ok = false;
+    }
+    stats.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return ok;
+}
+
+// ==================== GÉNÉRATEUR D'ARRIVÉES ====================
+// Scénario à arrivées dynamiques : chaque file reçoit, à chaque cycle de
+// [1, cycles], un nombre de processus tiré d'une loi de Poisson. En mode
+// rafale, la file alterne entre un régime normal et des rafales (débit
+// multiplié par burst) selon une chaîne de Markov à deux états.
+// Spécification : "poisson" ou "bursty", suivi d'options clé=valeur, par ex.
+//   bursty,rate=0.2,cycles=500,demand=40,burst=10,on=0.05,off=0.25,queues=1000,seed=7
+// queues=0 (défaut) : les trois files du scénario par défaut, processus initiaux
+// compris ; sinon files synthétiques RR/FIFO.
+enum class ArrivalPattern { Poisson, Bursty };
+
+struct ArrivalSpec {
+    ArrivalPattern pattern = ArrivalPattern::Poisson;
+    double rate = 0.2;          // arrivées moyennes par cycle et par file (hors rafale)
+    int cycles = 100;           // dernier cycle d'arrivée
+    double demand = 40.0;       // demande moyenne (1 + exponentielle)
+    double burst = 10.0;        // multiplicateur du débit en rafale
+    double burstOn = 0.05;      // probabilité d'entrer en rafale à chaque cycle
+    double burstOff = 0.25;     // probabilité d'en sortir
+    size_t queues = 0;
+    uint64_t seed = 42;
+};
+
+bool parseArrivalSpec(const string &text, ArrivalSpec &spec, string &error) {
+    stringstream list(text);
+    string item;
+    getline(list, item, ',');
+    if(item == "poisson") spec.pattern = ArrivalPattern::Poisson;
+    else if(item == "bursty") spec.pattern = ArrivalPattern::Bursty;
+    else { error = "loi inconnue « " + item + " » (poisson ou bursty)"; return false; }
+
+    while(getline(list, item, ',')) {
+        size_t equals = item.find('=');
+        string key = item.substr(0, equals);
+        double value;
+        if(equals == string::npos || !parseWorkloadNumber(string_view(item).substr(equals + 1), value) || value < 0) {
+            error = "option invalide « " + item + " »";
+            return false;
+        }
+        if(key == "rate") spec.rate = value;
+        else if(key == "cycles") spec.cycles = (int)value;
+        else if(key == "demand") spec.demand = max(1.0, value);
+        else if(key == "burst") spec.burst = value;
+        else if(key == "on") spec.burstOn = min(1.0, value);
+        else if(key == "off") spec.burstOff = min(1.0, value);
+        else if(key == "queues") spec.queues = (size_t)value;
+        else if(key == "seed") spec.seed = (uint64_t)value;
+        else { error = "option inconnue « " + key + " »"; return false; }
+    }
+    return true;
+}
+
+// Graine du flux d'une file (splitmix64) : le tirage d'une file ne dépend ni
+// des autres files, ni du nombre de threads, ni de l'ordre d'exécution.
+uint64_t arrivalStreamSeed(uint64_t seed, size_t queueIndex) {
+    uint64_t z = seed + 0x9E3779B97F4A7C15ULL * (queueIndex + 1);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+void generateQueueArrivals(Queue &q, size_t queueIndex, const ArrivalSpec &spec) {
+    mt19937_64 rng(arrivalStreamSeed(spec.seed, queueIndex));
+    exponential_distribution<double> extraDemand(1.0 / max(spec.demand - 1.0, 1e-9));
+    uniform_int_distribution<int> priority(1, 3);
+    bool bursting = false;
+    int count = 0;
+    for(int cycle = 1; cycle <= spec.cycles; cycle++) {
+        if(spec.pattern == ArrivalPattern::Bursty) {
+            bursting = bernoulli_distribution(bursting ? 1.0 - spec.burstOff : spec.burstOn)(rng);
+        }
+        double rate = bursting ? spec.rate * spec.burst : spec.rate;
+        int arrivals = rate > 0 ? poisson_distribution<int>(rate)(rng) : 0;
+        for(int k = 0; k < arrivals; k++) {
+            double demand = spec.demand > 1.0 ? round((1.0 + extraDemand(rng)) * 10) / 10 : 1.0;
+            int prio = priority(rng);
+            q.processes.push_back({"A" + to_string(queueIndex) + "_" + to_string(count++), demand, demand,
+                                   prio, false, 0.0, -1, -1, 0.0, (double)prio, cycle});
+        }
+    }
+}
+
+// Files générées en parallèle (une tâche par file), prêtes pour addQueue()
+vector<Queue> generateArrivalScenario(const ArrivalSpec &spec, unsigned threads) {
+    vector<Queue> queues;
+    if(spec.queues == 0) {
+        queues = defaultQueues();
+    } else {
+        for(size_t qi = 0; qi < spec.queues; qi++) {
+            Queue q;
+            q.name = "Q" + to_string(qi);
+            q.weight = 0.1 + (qi % 10) / 10.0;
+            q.policy = qi % 3 == 0 ? "FIFO" : "RR";
+            const QueueStyle *style = findQueueStyle("", qi);
+            q.color = style->color;
+            q.emoji = style->emoji;
+            queues.push_back(q);
+        }
+    }
+    if(threads == 0) threads = max(1u, thread::hardware_concurrency());
+    ThreadPool pool(threads);
+    pool.parallelFor(queues.size(), 1, [&](size_t begin, size_t end) {
+        for(size_t qi = begin; qi < end; qi++) generateQueueArrivals(queues[qi], qi, spec);
+    });
+    return queues;
+}
+
+// ==================== SERVICE ====================
+// Démon d'allocation : l'allocateur répond à des requêtes sur une socket Unix
+// (ou sur stdin/stdout). Protocole binaire à trames fixes, ordre natif :
+//   requête (32 octets)    u8 op, 3 réservés, u32 file, u32 processus,
+//                          i32 priorité, f64 valeur, u64 étiquette
+//     1 ajout   : file, valeur = demande, priorité -> valeur = processus
+//     2 retrait : file, processus
+//     3 poids   : file, valeur = poids
+//     4 tick    : valeur = quantum (0 : 10) -> valeur = cycle, allocations ;
+//                 refusé (sans cycle) si le quantum n'est pas fini, est
+//                 négatif ou sous ServiceMinQuantumShare de la ressource
+//     5 info    : -> valeur = nombre de files
+//   réponse (24 octets)    u8 op, u8 statut (0 ok, 1 refusé, 2 op inconnue),
+//                          u16 réservé, u32 nombre d'allocations qui suivent,
+//                          u64 étiquette (recopiée), u32 valeur, u32 réservé
+//   allocation (16 octets) u32 file, u32 processus (0xFFFFFFFF : quota de la
+//                          file ; bit 31 : processus terminé), f64 quantité
+// Un processus terminé ou retiré libère son identifiant, réutilisé ensuite.
+enum ServiceOp : uint8_t { AddProcess = 1, RemoveProcess = 2, SetWeight = 3, Tick = 4, Info = 5 };
+
+struct ServiceRequest {
+    uint8_t op;
+    uint8_t reserved[3];
+    uint32_t queue;
+    uint32_t process;
+    int32_t priority;
+    double value;
+    uint64_t tag;
+};
+
+struct ServiceReply {
+    uint8_t op;
+    uint8_t status;
+    uint16_t reserved;
+    uint32_t count;
+    uint64_t tag;
+    uint32_t value;
+    uint32_t reserved2;
+};
+
+struct ServiceGrant {
+    uint32_t queue;
+    uint32_t process;
+    double amount;
+};
+
+static_assert(sizeof(ServiceRequest) == 32 && sizeof(ServiceReply) == 24 && sizeof(ServiceGrant) == 16,
+              "trames du protocole de service");
+
+const uint32_t ServiceQuota = 0xFFFFFFFFu;
+// Quantum minimal d'un tick, en part de la ressource par cycle : un cycle
+// donne alors au plus un million de tranches pleines (plus une dernière
+// tranche par processus qui termine), quel que soit le client.
+const double ServiceMinQuantumShare = 1e-6;
+const uint32_t ServiceFinished = 0x80000000u;
+
+class AllocationService {
+public:
+    explicit AllocationService(ResourceAllocator &target) : allocator(target) {}
+
+    // Exécute les trames complètes de input (retirées) ; réponses ajoutées à output
+    void handle(string &input, string &output) {
+        size_t used = 0;
+        while(input.size() - used >= sizeof(ServiceRequest)) {
+            ServiceRequest request;
+            memcpy(&request, input.data() + used, sizeof(request));
+            used += sizeof(request);
+            execute(request, output);
+        }
+        input.erase(0, used);
+    }
+
+    size_t requests() const { return handled; }
+
+private:
+    ResourceAllocator &allocator;
+    vector<ResourceAllocator::CycleGrant> grants;
+    size_t handled = 0;
+
+    void execute(const ServiceRequest &request, string &output) {
+        ServiceReply reply{};
+        reply.op = request.op;
+        reply.tag = request.tag;
+        handled++;
+        switch(request.op) {
+        case AddProcess: {
+            int i = allocator.admitProcess(request.queue, request.value, max(1, (int)request.priority));
+            if(i < 0) reply.status = 1;
+            else reply.value = i;
+            break;
+        }
+        case RemoveProcess:
+            reply.status = allocator.retireProcess(request.queue, (int)min<uint32_t>(request.process, INT32_MAX)) ? 0 : 1;
+            break;
+        case SetWeight:
+            reply.status = allocator.setQueueWeight(request.queue, request.value) ? 0 : 1;
+            break;
+        case Tick: {
+            double unit = request.value == 0 ? 10.0 : request.value;
+            if(!isfinite(unit) || unit < allocator.cycleCapacity() * ServiceMinQuantumShare) {
+                reply.status = 1;
+                break;
+            }
+            reply.value = allocator.tick(unit, grants);
+            reply.count = grants.size();
+            output.append(reinterpret_cast<const char *>(&reply), sizeof(reply));
+            for(const auto &grant : grants) {
+                ServiceGrant record;
+                record.queue = grant.queue;
+                record.process = grant.process < 0 ? ServiceQuota
+                                                   : (uint32_t)grant.process | (grant.finished ? ServiceFinished : 0);
+                record.amount = grant.amount;
+                output.append(reinterpret_cast<const char *>(&record), sizeof(record));
+            }
+            return;
+        }
+        case Info:
+            reply.value = allocator.queueCount();
+            break;
+        default:
+            reply.status = 2;
+            break;
+        }
+        output.append(reinterpret_cast<const char *>(&reply), sizeof(reply));
+    }
+};
+
+#if defined(__unix__) || defined(__APPLE__)
+// Tube : trames lues sur stdin, réponses écrites sur stdout, jusqu'à la fin de stdin
+int runServicePipe(ResourceAllocator &allocator) {
+    AllocationService service(allocator);
+    string input, output;
+    vector<char> buffer(1 << 16);
+    while(true) {
+        ssize_t n = read(STDIN_FILENO, buffer.data(), buffer.size());
+        if(n < 0 && errno == EINTR) continue;
+        if(n <= 0) break;
+        input.append(buffer.data(), n);
+        service.handle(input, output);
+        size_t sent = 0;
+        while(sent < output.size()) {
+            ssize_t w = write(STDOUT_FILENO, output.data() + sent, output.size() - sent);
+            if(w < 0 && errno == EINTR) continue;
+            if(w <= 0) return 1;
+            sent += w;
+        }
+        output.clear();
+    }
+    return 0;
+}
+#else
+int runServicePipe(ResourceAllocator &) {
+    cerr << "Service: mode tube indisponible sur cette plateforme\n";
+    return 1;
+}
+#endif
+
+#if defined(__linux__)
+volatile sig_atomic_t serviceStopRequested = 0;
+
+void requestServiceStop(int) { serviceStopRequested = 1; }
+
+struct ServiceClient {
+    string input;
+    string output;
+    bool closed = false;        // fin de lecture : fermé une fois les réponses écrites
+    uint32_t interest = EPOLLIN | EPOLLRDHUP;   // événements epoll demandés
+};
+
+// Écrit ce que le noyau accepte ; faux si la connexion est rompue
+bool flushServiceClient(int fd, ServiceClient &client) {
+    size_t sent = 0;
+    while(sent < client.output.size()) {
+        ssize_t n = send(fd, client.output.data() + sent, client.output.size() - sent, MSG_NOSIGNAL);
+        if(n < 0 && errno == EINTR) continue;
+        if(n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        if(n <= 0) return false;
+        sent += n;
+    }
+    client.output.erase(0, sent);
+    return true;
+}
+
+// Boucle epoll : à chaque tour, lit tout ce qui est disponible chez tous les
+// clients prêts, exécute ce lot de requêtes d'affilée, puis écrit les
+// réponses de chaque client en un appel. Un client dont les réponses ne sont
+// pas toutes écrites n'est plus lu (EPOLLOUT seul) jusqu'à ce qu'il les ait
+// consommées ; après sa fin de lecture, il n'est plus suivi que pour écrire
+// le reste. Arrêt sur SIGINT/SIGTERM.
+int runServiceSocket(ResourceAllocator &allocator, const string &path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if(path.size() >= sizeof(address.sun_path)) {
+        cerr << "Service: chemin de socket trop long\n";
+        return 1;
+    }
+    memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+    int listener = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    unlink(path.c_str());
+    if(listener < 0 || bind(listener, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0
+       || listen(listener, SOMAXCONN) < 0) {
+        cerr << "Service: impossible d'écouter sur " << path << "\n";
+        if(listener >= 0) close(listener);
+        return 1;
+    }
+    int poller = epoll_create1(EPOLL_CLOEXEC);
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = listener;
+    epoll_ctl(poller, EPOLL_CTL_ADD, listener, &event);
+
+    struct sigaction action{};
+    action.sa_handler = requestServiceStop;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+
+    AllocationService service(allocator);
+    map<int, ServiceClient> clients;
+    vector<epoll_event> events(256);
+    vector<int> ready;
+    vector<char> buffer(1 << 16);
+    size_t batches = 0;
+    cerr << "service=" << path << " queues=" << allocator.queueCount() << "\n";
+
+    auto closeClient = [&](int fd) {
+        epoll_ctl(poller, EPOLL_CTL_DEL, fd, nullptr);
+        close(fd);
+        clients.erase(fd);
+    };
+
+    while(!serviceStopRequested) {
+        int n = epoll_wait(poller, events.data(), events.size(), -1);
+        if(n < 0) {
+            if(errno == EINTR) continue;
+            break;
+        }
+        ready.clear();
+        for(int k = 0; k < n; k++) {
+            int fd = events[k].data.fd;
+            if(fd == listener) {
+                int accepted;
+                while((accepted = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+                    epoll_event added{};
+                    added.events = EPOLLIN | EPOLLRDHUP;
+                    added.data.fd = accepted;
+                    epoll_ctl(poller, EPOLL_CTL_ADD, accepted, &added);
+                    clients[accepted];
+                }
+                continue;
+            }
+            ServiceClient &client = clients[fd];
+            if((client.interest & EPOLLIN) && (events[k].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))) {
+                while(true) {
+                    ssize_t got = read(fd, buffer.data(), buffer.size());
+                    if(got > 0) { client.input.append(buffer.data(), got); continue; }
+                    if(got < 0 && errno == EINTR) continue;
+                    if(got == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) client.closed = true;
+                    break;
+                }
+            }
+            ready.push_back(fd);
+        }
+
+        // Le lot du tour : requêtes de tous les clients prêts, puis les réponses
+        if(!ready.empty()) batches++;
+        for(int fd : ready) service.handle(clients[fd].input, clients[fd].output);
+        for(int fd : ready) {
+            ServiceClient &client = clients[fd];
+            if(!flushServiceClient(fd, client) || (client.closed && client.output.empty())) {
+                closeClient(fd);
+                continue;
+            }
+            // Réponses en attente : écriture seule (plus de lecture ni de EPOLLRDHUP)
+            uint32_t interest = client.output.empty() ? EPOLLIN | EPOLLRDHUP : EPOLLOUT;
+            if(interest != client.interest) {
+                epoll_event changed{};
+                changed.events = interest;
+                changed.data.fd = fd;
+                epoll_ctl(poller, EPOLL_CTL_MOD, fd, &changed);
+                client.interest = interest;
+            }
+        }
+    }
+
+    while(!clients.empty()) closeClient(clients.begin()->first);
+    close(poller);
+    close(listener);
+    unlink(path.c_str());
+    cerr << "requests=" << service.requests() << " batches=" << batches << "\n";
+    return 0;
+}
+
+bool sendFrame(int fd, const void *data, size_t size) {
+    const char *bytes = static_cast<const char *>(data);
+    while(size > 0) {
+        ssize_t n = send(fd, bytes, size, MSG_NOSIGNAL);
+        if(n < 0 && errno == EINTR) continue;
+        if(n <= 0) return false;
+        bytes += n;
+        size -= n;
+    }
+    return true;
+}
+
+bool receiveFrame(int fd, void *data, size_t size) {
+    char *bytes = static_cast<char *>(data);
+    while(size > 0) {
+        ssize_t n = recv(fd, bytes, size, 0);
+        if(n < 0 && errno == EINTR) continue;
+        if(n <= 0) return false;
+        bytes += n;
+        size -= n;
+    }
+    return true;
+}
+
+// Une connexion en boucle fermée : par itération, deux ajouts, un retrait
+// toutes les quatre itérations, puis un tick. Latences en microsecondes.
+bool runServiceLoadClient(const string &path, size_t iterations, unsigned seed,
+                          vector<double> &latencies, size_t &ticks) {
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    memcpy(address.sun_path, path.c_str(), min(path.size() + 1, sizeof(address.sun_path) - 1));
+    if(fd < 0 || connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0) {
+        if(fd >= 0) close(fd);
+        return false;
+    }
+
+    mt19937 rng(seed);
+    uniform_real_distribution<double> demand(5.0, 50.0);
+    vector<char> grants;
+    uint64_t tag = 0;
+    uint32_t queueCount = 1;
+    vector<pair<uint32_t, uint32_t>> added;
+    auto call = [&](ServiceRequest request, ServiceReply &reply) {
+        request.tag = ++tag;
+        auto start = chrono::steady_clock::now();
+        if(!sendFrame(fd, &request, sizeof(request)) || !receiveFrame(fd, &reply, sizeof(reply))) return false;
+        grants.resize((size_t)reply.count * sizeof(ServiceGrant));
+        if(!grants.empty() && !receiveFrame(fd, grants.data(), grants.size())) return false;
+        latencies.push_back(chrono::duration<double, micro>(chrono::steady_clock::now() - start).count());
+        return reply.tag == tag;
+    };
+
+    bool ok = true;
+    ServiceReply reply;
+    ServiceRequest info{};
+    info.op = Info;
+    if(call(info, reply)) queueCount = max<uint32_t>(1, reply.value);
+    else ok = false;
+    for(size_t it = 0; ok && it < iterations; it++) {
+        for(int k = 0; k < 2 && ok; k++) {
+            ServiceRequest add{};
+            add.op = AddProcess;
+            add.queue = rng() % queueCount;
+            add.priority = 1 + rng() % 3;
+            add.value = demand(rng);
+            ok = call(add, reply);
+            if(ok && reply.status == 0) added.push_back({add.queue, reply.value});
+        }
+        if(ok && it % 4 == 3 && !added.empty()) {
+            size_t pick = rng() % added.size();
+            ServiceRequest remove{};
+            remove.op = RemoveProcess;
+            remove.queue = added[pick].first;
+            remove.process = added[pick].second;
+            added[pick] = added.back();
+            added.pop_back();
+            ok = call(remove, reply);     // refusé si déjà terminé : normal
+        }
+        if(ok) {
+            ServiceRequest tick{};
+            tick.op = Tick;
+            tick.value = 10.0;
+            ok = call(tick, reply);
+            ticks++;
+        }
+    }
+    close(fd);
+    return ok;
+}
+
+// Montée en charge de 1 à maxClients connexions (puissances de 2) : débit de
+// ticks et percentiles de latence de toutes les requêtes
+int runServiceLoad(const string &path, unsigned maxClients, size_t iterations) {
+    double best = 0.0;
+    for(unsigned clients = 1; clients <= maxClients; clients = clients < maxClients ? min(clients * 2, maxClients) : clients + 1) {
+        vector<vector<double>> latencies(clients);
+        vector<size_t> ticks(clients, 0);
+        vector<char> ok(clients, 1);
+        auto start = chrono::steady_clock::now();
+        vector<thread> workers;
+        for(unsigned c = 0; c < clients; c++) {
+            workers.emplace_back([&, c] {
+                ok[c] = runServiceLoadClient(path, iterations, 1000 + c, latencies[c], ticks[c]);
+            });
+        }
+        for(auto &worker : workers) worker.join();
+        double wall = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        if(find(ok.begin(), ok.end(), 0) != ok.end()) {
+            cerr << "Charge: échec de connexion ou de réponse sur " << path << "\n";
+            return 1;
+        }
+
+        vector<double> all;
+        size_t tickTotal = 0;
+        for(unsigned c = 0; c < clients; c++) {
+            all.insert(all.end(), latencies[c].begin(), latencies[c].end());
+            tickTotal += ticks[c];
+        }
+        sort(all.begin(), all.end());
+        auto percentile = [&](double q) { return all.empty() ? 0.0 : all[min(all.size() - 1, (size_t)(q * all.size()))]; };
+        double ticksPerSecond = tickTotal / wall;
+        best = max(best, ticksPerSecond);
+        cout << "clients=" << clients << " requests=" << all.size() << " ticks=" << tickTotal
+             << fixed << setprecision(1)
+             << " ticks_per_s=" << ticksPerSecond << " requests_per_s=" << all.size() / wall
+             << " p50_us=" << percentile(0.50) << " p99_us=" << percentile(0.99)
+             << " p999_us=" << percentile(0.999) << "\n";
+        cout.unsetf(ios::floatfield);
+    }
+    cout << "max_ticks_per_s=" << fixed << setprecision(1) << best << "\n";
+    cout.unsetf(ios::floatfield);
+    return 0;
+}
+#else
+int runServiceSocket(ResourceAllocator &, const string &) {
+    cerr << "Service: socket Unix et epoll requis (Linux)\n";
+    return 1;
+}
+
+int runServiceLoad(const string &, unsigned, size_t) {
+    cerr << "Charge: socket Unix requise (Linux)\n";
+    return 1;
+}
+#endif
+
+// ==================== VARIANTES (ET SI) ====================
+// --what-if CYCLE SPEC : la simulation avance jusqu'au cycle CYCLE, puis
+// chaque variante repart de cet état dans sa propre branche (forkVariants).
+// SPEC : variantes séparées par « ; », chacune une liste « file=poids »
+// séparée par des virgules (indice de file à partir de 0), par exemple
+// « 0=0.2,2=0.6;1=0.9 ». La branche de référence (poids inchangés) est
+// toujours calculée en premier.
+typedef vector<pair<size_t, double>> WeightChanges;
+
+bool parseWhatIfSpec(const string &text, size_t queueCount, vector<WeightChanges> &variants, string &error) {
+    variants.clear();
+    stringstream list(text);
+    string variant;
+    while(getline(list, variant, ';')) {
+        WeightChanges changes;
+        stringstream items(variant);
+        string item;
+        while(getline(items, item, ',')) {
+            size_t eq = item.find('=');
+            int queue;
+            double weight;
+            if(eq == string::npos || !parseWorkloadInteger(string_view(item).substr(0, eq), queue) ||
+               !parseWorkloadNumber(string_view(item).substr(eq + 1), weight) || weight < 0) {
+                error = "changement invalide « " + item + " » (file=poids attendu)";
+                return false;
+            }
+            if(queue < 0 || (size_t)queue >= queueCount) {
+                error = "file inconnue " + to_string(queue);
+                return false;
+            }
+            changes.push_back({(size_t)queue, weight});
+        }
+        if(changes.empty()) {
+            error = "variante vide";
+            return false;
+        }
+        variants.push_back(changes);
+    }
+    if(variants.empty()) error = "aucune variante";
+    return !variants.empty();
+}
+
+int runWhatIf(ResourceAllocator &allocator, int cycle, const string &spec, unsigned parallel, double unit) {
+    vector<WeightChanges> variants;
+    string error;
+    if(!parseWhatIfSpec(spec, allocator.queueCount(), variants, error)) {
+        cerr << "Variantes: " << error << "\n";
+        return 1;
+    }
+    auto start = chrono::steady_clock::now();
+    allocator.advanceTo(cycle, unit);
+    double shared = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    int branchCycle = allocator.cycle();
+
+    vector<function<void(ResourceAllocator &)>> branches = {[](ResourceAllocator &) {}};
+    for(const auto &changes : variants) {
+        branches.push_back([&changes](ResourceAllocator &branch) {
+            for(const auto &[queue, weight] : changes) branch.setQueueWeight(queue, weight);
+        });
+    }
+    start = chrono::steady_clock::now();
+    vector<RunSummary> results = allocator.forkVariants(branches, unit, parallel, error);
+    double wall = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    if(results.empty()) {
+        cerr << "Variantes: " << error << "\n";
+        return 1;
+    }
+
+    stringstream labels(spec);
+    string label = "base";
+    for(size_t k = 0; k < results.size(); k++) {
+        if(k > 0) getline(labels, label, ';');
+        const RunSummary &summary = results[k];
+        cout << "variant=" << k << " weights=" << label << " cycles=" << summary.cycles
+             << fixed << setprecision(3) << " mean_utilization=" << summary.meanUtilization
+             << setprecision(2) << " mean_response=" << summary.meanResponse
+             << " mean_wait=" << summary.meanWait << " max_wait=" << summary.maxWait;
+        for(size_t qi = 0; qi < summary.queueCompletion.size(); qi++) {
+            cout << " q" << qi << "_done=" << summary.queueCompletion[qi];
+        }
+        cout << setprecision(6) << " wall_s=" << summary.wallSeconds << "\n";
+        cout.unsetf(ios::floatfield);
+    }
+    cerr << "branch_cycle=" << branchCycle << " variants=" << results.size()
+         << fixed << setprecision(3) << " prefix_s=" << shared << " branches_s=" << wall << "\n";
+    cerr.unsetf(ios::floatfield);
+    return 0;
+}
+
+// ==================== BENCHMARKS ====================
+// Réductions de demande + calcul des quotas : AoS scalaire (l'ancien runCycle)
+// contre ProcessTable SoA + noyaux vectorisés, sur n processus.
+void runSoaBenchmark(size_t n, size_t queueCount = 1000, int rounds = 20) {
+    mt19937 rng(42);
+    uniform_real_distribution<double> demand(1.0, 500.0);
+
+    vector<Queue> aos(queueCount);
+    ProcessTable table;
+    vector<double> weights(queueCount);
+    vector<pair<size_t, size_t>> ranges(queueCount);
+    for(size_t qi = 0; qi < queueCount; qi++) {
+        aos[qi].weight = weights[qi] = 0.1 + (qi % 10) / 10.0;
+        size_t count = n / queueCount + (qi < n % queueCount ? 1 : 0);
+        ranges[qi].first = table.size();
+        for(size_t i = 0; i < count; i++) {
+            double d = demand(rng);
+            Process p{"P" + to_string(table.size()), d, d, 1, rng() % 10 < 3};
+            aos[qi].processes.push_back(p);
+            table.append(p, qi);
+        }
+        ranges[qi].second = table.size();
+    }
+
+    vector<double> sums(queueCount), quotas(queueCount);
+    double checkAos = 0, checkSoa = 0;
+
+    auto t0 = chrono::steady_clock::now();
+    for(int r = 0; r < rounds; r++) {
+        double totalWeight = 0;
+        for(size_t qi = 0; qi < queueCount; qi++) {
+            double demandSum = 0;
+            for(auto &p : aos[qi].processes) {
+                if(!p.finished) demandSum += p.remaining;
+            }
+            sums[qi] = demandSum;
+            totalWeight += aos[qi].weight * demandSum;
+        }
+        for(size_t qi = 0; qi < queueCount; qi++) {
+            quotas[qi] = totalWeight > 0 ? (aos[qi].weight * sums[qi] / totalWeight) * 100.0 : 0;
+        }
+        checkAos += quotas[0];
+    }
+    auto t1 = chrono::steady_clock::now();
+    for(int r = 0; r < rounds; r++) {
+        for(size_t qi = 0; qi < queueCount; qi++) {
+            sums[qi] = Kernels::sumUnfinished(table.remaining.data(), table.finishedMask.data(),
+                                              ranges[qi].first, ranges[qi].second);
+        }
+        double totalWeight = Kernels::weightedTotal(weights.data(), sums.data(), queueCount);
+        Kernels::computeQuotas(weights.data(), sums.data(), totalWeight, 100.0, quotas.data(), queueCount);
+        checkSoa += quotas[0];
+    }
+    auto t2 = chrono::steady_clock::now();
+
+    double aosNs = chrono::duration<double, nano>(t1 - t0).count() / rounds;
+    double soaNs = chrono::duration<double, nano>(t2 - t1).count() / rounds;
+#if defined(__AVX2__)
+    const char *isa = "avx2";
+#elif defined(__SSE2__)
+    const char *isa = "sse2";
+#else
+    const char *isa = "scalar";
+#endif
+    cout << "processes=" << n << " queues=" << queueCount << " isa=" << isa << "\n";
+    cout << fixed << setprecision(3);
+    cout << "aos_scalar_ms=" << aosNs / 1e6 << " ns_per_process=" << aosNs / n << "\n";
+    cout << "soa_" << isa << "_ms=" << soaNs / 1e6 << " ns_per_process=" << soaNs / n << "\n";
+    cout << "speedup=" << setprecision(2) << aosNs / soaNs
+         << " quota_delta=" << scientific << fabs(checkAos - checkSoa) / rounds << "\n";
+}
+
+// Files synthétiques des benchmarks : RR et FIFO entrelacées, ou toutes de la
+// politique `policy` si elle est donnée
+void addSyntheticQueues(ResourceAllocator &allocator, size_t queueCount, size_t processesPerQueue,
+                        const string &policy = "") {
+    mt19937 rng(42);
+    uniform_real_distribution<double> demand(10.0, 100.0);
+    for(size_t qi = 0; qi < queueCount; qi++) {
+        Queue q;
+        q.name = "Q" + to_string(qi);
+        q.weight = 0.1 + (qi % 10) / 10.0;
+        q.policy = !policy.empty() ? policy : qi % 3 == 0 ? "FIFO" : "RR";
+        for(size_t i = 0; i < processesPerQueue; i++) {
+            double d = demand(rng);
+            int priority = 1 + i % 3;
+            q.processes.push_back({q.name + "_P" + to_string(i), d, d, priority, false,
+                                   0.0, -1, -1, 0.0, (double)priority});
+        }
+        allocator.addQueue(q);
+    }
+}
+
+// Cycles/s du moteur pas à pas (journaux compris) selon le nombre de threads,
+// sur queueCount files de processesPerQueue processus
+void runThreadScalingBenchmark(size_t queueCount = 4000, size_t processesPerQueue = 50) {
+    unsigned maxThreads = max(1u, thread::hardware_concurrency());
+    vector<unsigned> counts;
+    for(unsigned t = 1; t < maxThreads; t *= 2) counts.push_back(t);
+    counts.push_back(maxThreads);
+
+    cout << "queues=" << queueCount << " processes=" << queueCount * processesPerQueue
+         << " hardware_threads=" << maxThreads << "\n";
+    double serialRate = 0;
+    for(unsigned threads : counts) {
+        ResourceAllocator allocator(queueCount * 100.0);
+        allocator.setThreads(threads);
+        addSyntheticQueues(allocator, queueCount, processesPerQueue);
+        RunSummary summary = allocator.runHeadless(10.0);
+        if(threads == 1) serialRate = summary.cyclesPerSecond;
+        cout << "threads=" << threads << " cycles=" << summary.cycles
+             << " wall_s=" << fixed << setprecision(6) << summary.wallSeconds
+             << " cycles_per_s=" << setprecision(1) << summary.cyclesPerSecond
+             << " speedup=" << setprecision(2) << summary.cyclesPerSecond / serialRate << "\n";
+    }
+}
+
+// Cycles/s du moteur fragmenté selon le nombre de processus (jusqu'à
+// maxShards, 0 : un par cœur), sans journaux ; chaque mesure est comparée
+// au moteur en un seul processus (résumé et état final de chaque processus)
+void runShardScalingBenchmark(size_t queueCount = 4000, unsigned maxShards = 0, size_t processesPerQueue = 50) {
+    if(maxShards == 0) maxShards = max(1u, thread::hardware_concurrency());
+    vector<unsigned> counts;
+    for(unsigned s = 1; s < maxShards; s *= 2) counts.push_back(s);
+    counts.push_back(maxShards);
+
+    ResourceAllocator reference(queueCount * 100.0, "", "");
+    reference.setHistoryRetention(1);
+    addSyntheticQueues(reference, queueCount, processesPerQueue);
+    RunSummary expected = reference.runHeadless(10.0);
+
+    cout << "queues=" << queueCount << " processes=" << queueCount * processesPerQueue
+         << " hardware_threads=" << thread::hardware_concurrency() << "\n";
+    for(unsigned shards : counts) {
+        ResourceAllocator allocator(queueCount * 100.0, "", "");
+        allocator.setHistoryRetention(1);
+        addSyntheticQueues(allocator, queueCount, processesPerQueue);
+        string error;
+        RunSummary summary = allocator.runSharded(10.0, shards, error);
+        if(!error.empty()) {
+            cout << "shards=" << shards << " error=\"" << error << "\"\n";
+            return;
+        }
+        bool identical = summary.cycles == expected.cycles && summary.allocations == expected.allocations &&
+                         summary.meanUtilization == expected.meanUtilization &&
+                         summary.meanResponse == expected.meanResponse && summary.meanWait == expected.meanWait &&
+                         summary.queueCompletion == expected.queueCompletion;
+        for(size_t qi = 0; qi < queueCount && identical; qi++) {
+            const Queue &a = allocator.queueAt(qi), &b = reference.queueAt(qi);
+            identical = a.totalAllocated == b.totalAllocated;
+            for(size_t i = 0; i < a.processes.size() && identical; i++) {
+                const Process &p = a.processes[i], &r = b.processes[i];
+                identical = p.allocated == r.allocated && p.remaining == r.remaining &&
+                            p.startCycle == r.startCycle && p.endCycle == r.endCycle && p.priority == r.priority;
+            }
+        }
+        cout << "shards=" << shards << " cycles=" << summary.cycles
+             << " wall_s=" << fixed << setprecision(6) << summary.wallSeconds
+             << " cycles_per_s=" << setprecision(1) << summary.cyclesPerSecond
+             << " speedup=" << setprecision(2) << expected.wallSeconds / summary.wallSeconds
+             << " identical=" << (identical ? "yes" : "no") << "\n";
+        cout.unsetf(ios::floatfield);
+    }
+}
+
+// Soumissions concurrentes : `producers` threads soumettent des lots de
+// `batch` processus dans des files tirées au hasard (le premier d'un lot sur
+// dix est annulé aussitôt) pendant que le moteur enchaîne les cycles (tick).
+// Débit des producteurs (jusqu'au dernier lot), cycles du moteur et bilan : toute soumission est
+// admise, et chaque processus admis termine ou est annulé.
+void runSubmissionBenchmark(unsigned producers = 4, size_t perProducer = 200000, size_t batch = 16) {
+    const size_t queueCount = 64;
+    ResourceAllocator allocator(queueCount * 100.0, "", "");
+    allocator.setHistoryRetention(1);
+    addSyntheticQueues(allocator, queueCount, 4);
+    allocator.enableSubmissions();
+
+    atomic<unsigned> running{producers};
+    atomic<long long> producerNs{0};
+    atomic<long long> cancels{0};
+    vector<thread> threads;
+    auto start = chrono::steady_clock::now();
+    for(unsigned t = 0; t < producers; t++) {
+        threads.emplace_back([&, t] {
+            mt19937 rng(t + 1);
+            uniform_real_distribution<double> demand(10.0, 100.0);
+            vector<double> demands(batch);
+            vector<int> priorities(batch);
+            long long sent = 0;
+            auto begin = chrono::steady_clock::now();
+            for(size_t k = 0; k * batch < perProducer; k++) {
+                SubmissionChannel &channel = allocator.submissions(rng() % queueCount);
+                for(size_t b = 0; b < batch; b++) {
+                    demands[b] = demand(rng);
+                    priorities[b] = 1 + b % 3;
+                }
+                uint64_t first = channel.submitBatch(demands.data(), priorities.data(), batch);
+                if(k % 10 == 0) {
+                    channel.cancel(first);
+                    sent++;
+                }
+            }
+            producerNs += chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - begin).count();
+            cancels += sent;
+            running--;
+        });
+    }
+
+    vector<ResourceAllocator::CycleGrant> grants;
+    long long cycles = 0;
+    while(running.load() > 0) {
+        allocator.tick(10.0, grants);
+        cycles++;
+    }
+    double submitWall = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    for(auto &t : threads) t.join();
+    do {
+        allocator.tick(10.0, grants);
+        cycles++;
+    } while(!allocator.allProcessesFinished());
+    double wall = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    const SubmissionHub &hub = *allocator.submissionCounts();
+    long long submitted = 0;
+    for(size_t qi = 0; qi < queueCount; qi++) submitted += allocator.submissions(qi).ticketsIssued();
+    long long items = submitted + cancels.load();
+    bool consistent = hub.admitted == submitted && hub.cancelled + hub.ignored == cancels.load() &&
+                      allocator.allProcessesFinished();
+    cout << "producers=" << producers << " batch=" << batch << " submitted=" << submitted
+         << " admitted=" << hub.admitted << " cancelled=" << hub.cancelled << " ignored=" << hub.ignored
+         << " cycles=" << cycles << fixed << setprecision(6) << " wall_s=" << wall
+         << setprecision(1) << " submissions_per_s=" << items / submitWall
+         << " producer_ns_per_submission=" << (double)producerNs.load() / items
+         << " cycles_per_s=" << cycles / wall
+         << " consistent=" << (consistent ? "yes" : "no") << "\n";
+    cout.unsetf(ios::floatfield);
+}
+
+// Répartition par plages de même politique contre comparaison de chaînes
+// file par file, sans journaux (seul le coût du moteur est mesuré). Deux
+// dispositions : RR et FIFO entrelacées (plages d'une ou deux files), puis
+// regroupées (un tiers FIFO puis deux tiers RR : deux plages).
+void runPolicyDispatchBenchmark(size_t queueCount = 20000, size_t processesPerQueue = 4) {
+    cout << "queues=" << queueCount << " processes=" << queueCount * processesPerQueue << "\n";
+    for(bool clustered : {false, true}) {
+        double byNameSeconds = 0;
+        for(PolicyDispatch mode : {PolicyDispatch::ByName, PolicyDispatch::Grouped}) {
+            ResourceAllocator allocator(queueCount * 20.0, "", "");
+            allocator.setPolicyDispatch(mode);
+            allocator.setHistoryRetention(1);
+            if(clustered) {
+                addSyntheticQueues(allocator, queueCount / 3, processesPerQueue, "FIFO");
+                addSyntheticQueues(allocator, queueCount - queueCount / 3, processesPerQueue, "RR");
+            } else {
+                addSyntheticQueues(allocator, queueCount, processesPerQueue);
+            }
+            RunSummary summary = allocator.runHeadless(1.0);
+            if(mode == PolicyDispatch::ByName) byNameSeconds = summary.wallSeconds;
+            double passes = (double)summary.cycles * queueCount;
+            cout << (mode == PolicyDispatch::ByName ? "string_dispatch" : "policy_runs")
+                 << " layout=" << (clustered ? "clustered" : "interleaved")
+                 << " cycles=" << summary.cycles
+                 << " wall_s=" << fixed << setprecision(6) << summary.wallSeconds
+                 << " ns_per_queue_pass=" << setprecision(1) << summary.wallSeconds * 1e9 / passes
+                 << " speedup=" << setprecision(2) << byNameSeconds / summary.wallSeconds << "\n";
+            cout.unsetf(ios::floatfield);
+        }
+    }
+}
+
+// Charge déséquilibrée pour comparer les attentes : par file, un arriéré de
+// processus de priorité 1 au départ, puis des arrivées de priorité 3 (chaque
+// cycle, tout le quota en moyenne) et de priorité 1 (tous les 4 cycles)
+// jusqu'au cycle 150
+void addSkewedQueues(ResourceAllocator &allocator, size_t queueCount, const string &policy) {
+    mt19937 rng(7);
+    uniform_real_distribution<double> backlog(20.0, 60.0), urgent(15.0, 25.0), late(10.0, 40.0);
+    for(size_t qi = 0; qi < queueCount; qi++) {
+        Queue &q = allocator.openQueue();
+        q.name = "Q" + to_string(qi);
+        q.weight = 1.0;
+        q.policy = policy;
+        int n = 0;
+        for(int i = 0; i < 40; i++) allocator.appendProcess(q.name + "_P" + to_string(n++), backlog(rng), 1);
+        for(int c = 2; c <= 150; c++) {
+            allocator.appendProcess(q.name + "_P" + to_string(n++), urgent(rng), 3, c);
+            if(c % 4 == 0) allocator.appendProcess(q.name + "_P" + to_string(n++), late(rng), 1, c);
+        }
+        allocator.closeQueue();
+    }
+}
+
+// Attente avant le premier service sur la charge déséquilibrée : RR, PRIO
+// (vieillissement paresseux) et PRIO sans vieillissement, écarts relatifs à RR
+void runAgingBenchmark(size_t queueCount = 100) {
+    struct Variant { const char *label; const char *policy; bool aging; };
+    const Variant variants[] = {{"RR", "RR", true}, {"PRIO", "PRIO", true}, {"PRIO_no_aging", "PRIO", false}};
+    cout << "queues=" << queueCount << " quota_per_queue=20 unit=5 aging_factor=0.05\n";
+    RunSummary rr;
+    for(const Variant &variant : variants) {
+        ResourceAllocator allocator(queueCount * 20.0, "", "");
+        allocator.setHistoryRetention(1);
+        allocator.setAging(variant.aging, 0.05);
+        addSkewedQueues(allocator, queueCount, variant.policy);
+        RunSummary summary = allocator.runHeadless(5.0);
+        if(variant.policy == string("RR")) rr = summary;
+        cout << "policy=" << variant.label << " cycles=" << summary.cycles
+             << fixed << setprecision(2) << " mean_wait=" << summary.meanWait << " max_wait=" << summary.maxWait;
+        for(const auto &[priority, wait] : summary.waitByPriority) {
+            cout << " p" << priority << "_mean_wait=" << wait.first << " p" << priority << "_max_wait=" << wait.second;
+        }
+        cout << " mean_response=" << summary.meanResponse
+             << " max_wait_vs_rr=" << showpos << summary.maxWait - rr.maxWait << noshowpos;
+        for(const auto &[priority, wait] : summary.waitByPriority) {
+            cout << " p" << priority << "_max_wait_vs_rr=" << showpos
+                 << wait.second - rr.waitByPriority[priority].second << noshowpos;
+        }
+        cout << " wall_s=" << setprecision(6) << summary.wallSeconds << "\n";
+        cout.unsetf(ios::floatfield);
+    }
+}
+
+// Évaluation de la hiérarchie : arbre locataires → équipes → files (100 files
+// par équipe, 10 équipes par locataire), une fraction des demandes modifiée
+// avant chaque évaluation. Incrémental (balayage des files ou liste des
+// changements) contre recalcul complet, quotas comparés.
+void runHierarchyBenchmark(size_t leafCount = 100000, int rounds = 200) {
+    const size_t perTeam = 100, teamsPerTenant = 10;
+    QueueHierarchy tree;
+    size_t teams = max<size_t>(1, leafCount / perTeam);
+    mt19937 rng(11);
+    uniform_real_distribution<double> unit(0.0, 1.0);
+    size_t queueCount = 0;
+    int tenant = -1;
+    for(size_t t = 0; t < teams; t++) {
+        if(t % teamsPerTenant == 0) tenant = tree.addGroup("T" + to_string(t / teamsPerTenant), 1.0 + unit(rng), -1);
+        int team = tree.addGroup("T" + to_string(t / teamsPerTenant) + "/E" + to_string(t), 0.5 + unit(rng), tenant);
+        for(size_t i = 0; i < perTeam; i++, queueCount++) tree.addQueue(team);
+    }
+    vector<double> weights(queueCount), demands(queueCount);
+    for(size_t q = 0; q < queueCount; q++) {
+        weights[q] = 0.1 + unit(rng);
+        demands[q] = 100.0 * unit(rng);
+    }
+    tree.evaluate(weights.data(), demands.data(), 1e6);
+    QueueHierarchy listed = tree, full = tree;
+    vector<int> changed;
+
+    cout << "nodes=" << tree.nodeCount() << " queues=" << queueCount << " groups=" << tree.groupCount()
+         << " rounds=" << rounds << "\n";
+    for(double fraction : {0.0001, 0.001, 0.01, 0.1, 1.0}) {
+        size_t changes = max<size_t>(1, fraction * queueCount);
+        double scanned = 0.0, incremental = 0.0, complete = 0.0, delta = 0.0;
+        for(int r = 0; r < rounds; r++) {
+            changed.clear();
+            for(size_t k = 0; k < changes; k++) {
+                changed.push_back(rng() % queueCount);
+                demands[changed.back()] = 100.0 * unit(rng);
+            }
+            auto start = chrono::steady_clock::now();
+            tree.evaluate(weights.data(), demands.data(), 1e6);
+            auto t1 = chrono::steady_clock::now();
+            listed.evaluate(weights.data(), demands.data(), 1e6, changed);
+            auto t2 = chrono::steady_clock::now();
+            full.touchAll();
+            full.evaluate(weights.data(), demands.data(), 1e6);
+            auto stop = chrono::steady_clock::now();
+            scanned += chrono::duration<double>(t1 - start).count();
+            incremental += chrono::duration<double>(t2 - t1).count();
+            complete += chrono::duration<double>(stop - t2).count();
+            for(size_t q = 0; q < queueCount; q++) {
+                delta = max({delta, fabs(tree.quota(q) - full.quota(q)), fabs(listed.quota(q) - full.quota(q))});
+            }
+        }
+        cout << "changed_fraction=" << fraction << " changed_queues=" << changes
+             << fixed << setprecision(1) << " scan_us=" << scanned * 1e6 / rounds
+             << " listed_us=" << incremental * 1e6 / rounds << " full_us=" << complete * 1e6 / rounds
+             << setprecision(2) << " speedup=" << complete / max(incremental, 1e-12)
+             << scientific << setprecision(1) << " max_quota_delta=" << delta << "\n";
+        cout.unsetf(ios::floatfield);
+    }
+}
+
+// DRF : coût d'une tranche selon le nombre de ressources (besoins tirés dans
+// [0.1, 1] par ressource, capacités réglées pour servir ~10 % de la demande
+// par cycle), à côté de l'allocation à plat. Vérifie aussi l'exemple classique
+// 9 CPU / 18 Go : A (1 CPU, 4 Go) et B (3 CPU, 1 Go) reçoivent 3 et 2 unités
+// par cycle, soit des parts dominantes égales (2/3).
+void runDrfBenchmark(size_t processCount = 10000) {
+    const size_t queueCount = 100;
+    const double unit = 10.0;
+    size_t perQueue = max<size_t>(1, processCount / queueCount);
+    cout << "queues=" << queueCount << " processes=" << queueCount * perQueue << " unit=" << unit << "\n";
+    for(size_t dims : {0, 1, 2, 4, 8}) {
+        ResourceAllocator allocator(queueCount * 100.0, "", "");
+        allocator.setHistoryRetention(1);
+        mt19937 rng(42);
+        uniform_real_distribution<double> demand(10.0, 100.0), share(0.1, 1.0);
+        for(size_t qi = 0; qi < queueCount; qi++) {
+            Queue &q = allocator.openQueue();
+            q.name = "Q" + to_string(qi);
+            q.weight = 0.1 + (qi % 10) / 10.0;
+            q.policy = "RR";
+            for(size_t i = 0; i < perQueue; i++) {
+                ResourceVector need;
+                for(size_t r = 0; r < dims; r++) need[r] = share(rng);
+                allocator.appendProcess(q.name + "_P" + to_string(i), demand(rng), 1, 0, need);
+            }
+            allocator.closeQueue();
+        }
+        if(dims > 0) {
+            vector<string> names;
+            for(size_t r = 0; r < dims; r++) names.push_back("r" + to_string(r));
+            vector<double> capacities(dims, 0.1 * queueCount * perQueue * unit * 0.55);
+            string error;
+            if(!allocator.setResources(names, capacities, true, error)) {
+                cerr << "DRF: " << error << "\n";
+                return;
+            }
+        }
+        RunSummary summary = allocator.runHeadless(unit);
+        cout << "dims=" << (dims == 0 ? string("flat") : to_string(dims)) << " cycles=" << summary.cycles
+             << " allocations=" << summary.allocations
+             << fixed << setprecision(6) << " wall_s=" << summary.wallSeconds
+             << setprecision(1) << " ns_per_grant=" << summary.wallSeconds * 1e9 / max<long long>(1, summary.allocations)
+             << " mean_utilization=" << summary.meanUtilization << "\n";
+        cout.unsetf(ios::floatfield);
+    }
+
+    ResourceAllocator classic(1.0, "", "");
+    for(const auto &[name, demand, cpu, mem] : {tuple{"A", 30.0, 1.0, 4.0}, tuple{"B", 20.0, 3.0, 1.0}}) {
+        Queue &q = classic.openQueue();
+        q.name = name;
+        q.weight = 1.0;
+        q.policy = "RR";
+        ResourceVector need;
+        need[0] = cpu;
+        need[1] = mem;
+        classic.appendProcess(string(name) + "_P0", demand, 1, 0, need);
+        classic.closeQueue();
+    }
+    string error;
+    classic.setResources({"cpu", "mem"}, {9.0, 18.0}, false, error);
+    RunSummary summary = classic.runHeadless(0.25);
+    bool ok = summary.queueCompletion == vector<int>{10, 10} && fabs(summary.meanUtilization - 100.0) < 1e-9;
+    cout << "classic cpu=9 mem=18 A=(1,4)x30 B=(3,1)x20 cycles=" << summary.cycles
+         << " a_done=" << summary.queueCompletion[0] << " b_done=" << summary.queueCompletion[1]
+         << " mean_utilization=" << summary.meanUtilization << " check=" << (ok ? "ok" : "FAIL") << "\n";
+}
+
+// Instantanés : enregistrement et restauration à mi-parcours, suite restaurée
+// comparée à l'exécution d'une traite ; puis `variants` variantes de poids
+// depuis ce point, par fork (un fils à la fois, puis un par cœur) contre un
+// rejeu complet depuis le cycle 1 pour chacune.
+void runSnapshotBenchmark(size_t processCount = 200000, size_t variants = 8) {
+    const size_t queueCount = 1000;
+    const double unit = 10.0;
+    size_t perQueue = max<size_t>(1, processCount / queueCount);
+    auto build = [&](ResourceAllocator &allocator) {
+        allocator.setHistoryRetention(1);
+        addSyntheticQueues(allocator, queueCount, perQueue);
+    };
+    auto seconds = [](chrono::steady_clock::time_point since) {
+        return chrono::duration<double>(chrono::steady_clock::now() - since).count();
+    };
+    auto same = [](const RunSummary &a, const RunSummary &b) {
+        return a.cycles == b.cycles && a.allocations == b.allocations && a.meanUtilization == b.meanUtilization &&
+               a.meanResponse == b.meanResponse && a.meanWait == b.meanWait && a.queueCompletion == b.queueCompletion;
+    };
+
+    ResourceAllocator straight(queueCount * 100.0, "", "");
+    build(straight);
+    RunSummary reference = straight.runHeadless(unit);
+    int middle = reference.cycles / 2;
+
+    ResourceAllocator source(queueCount * 100.0, "", "");
+    build(source);
+    auto start = chrono::steady_clock::now();
+    source.advanceTo(middle, unit);
+    double prefix = seconds(start);
+    const string path = "snapshot_bench.bin";
+    string error;
+    start = chrono::steady_clock::now();
+    if(!source.writeSnapshot(path, error)) {
+        cerr << "Instantané: " << error << "\n";
+        return;
+    }
+    double saved = seconds(start);
+    ResourceAllocator restored(1.0, "", "");
+    start = chrono::steady_clock::now();
+    bool loaded = restored.loadSnapshot(path, error);
+    double restore = seconds(start);
+    ifstream sizeProbe(path, ios::binary | ios::ate);
+    size_t bytes = sizeProbe.tellg();
+    remove(path.c_str());
+    if(!loaded) {
+        cerr << "Instantané: " << error << "\n";
+        return;
+    }
+    RunSummary resumed = restored.runHeadless(unit);
+    cout << "queues=" << queueCount << " processes=" << queueCount * perQueue << " cycles=" << reference.cycles
+         << " snapshot_cycle=" << middle << " bytes=" << bytes << fixed << setprecision(4)
+         << " prefix_s=" << prefix << " save_s=" << saved << " restore_s=" << restore
+         << " resumed_identical=" << (same(resumed, reference) ? "yes" : "NO") << "\n";
+
+    mt19937 rng(3);
+    uniform_real_distribution<double> weight(0.1, 1.0);
+    vector<WeightChanges> changes(variants);
+    for(auto &change : changes) {
+        for(int k = 0; k < 50; k++) change.push_back({rng() % queueCount, weight(rng)});
+    }
+    vector<function<void(ResourceAllocator &)>> branches;
+    for(const auto &change : changes) {
+        branches.push_back([&change](ResourceAllocator &branch) {
+            for(const auto &[queue, w] : change) branch.setQueueWeight(queue, w);
+        });
+    }
+    vector<RunSummary> forked;
+    for(unsigned parallel : {1u, 0u}) {
+        start = chrono::steady_clock::now();
+        forked = source.forkVariants(branches, unit, parallel, error);
+        double wall = seconds(start);
+        if(forked.empty()) {
+            cerr << "Variantes: " << error << "\n";
+            return;
+        }
+        cout << "variants=" << variants << " mode=fork parallel=" << (parallel ? to_string(parallel) : "cores")
+             << " wall_s=" << wall << "\n";
+    }
+    start = chrono::steady_clock::now();
+    bool identical = true;
+    for(size_t k = 0; k < variants; k++) {
+        ResourceAllocator replay(queueCount * 100.0, "", "");
+        build(replay);
+        replay.advanceTo(middle, unit);
+        branches[k](replay);
+        identical = identical && same(replay.runHeadless(unit), forked[k]);
+    }
+    cout << "variants=" << variants << " mode=replay wall_s=" << seconds(start)
+         << " forked_identical=" << (identical ? "yes" : "NO") << "\n";
+    cout.unsetf(ios::floatfield);
+}
+
+// ==================== BALAYAGE DE PARAMÈTRES ====================
+// Fichier de description, une ligne par paramètre (# : commentaire) :
+//   unit 5,10,20          valeurs énumérées (grille : produit cartésien)
+//   weight.0 0.1:0.9      intervalle, tiré uniformément (recherche aléatoire)
+//   policy.2 RR,FIFO
+//   samples 1000          recherche aléatoire de 1000 tirages au lieu de la grille
+//   seed 42
+// Paramètres : unit, resource, aging (0/1), agingFactor, weight.<file>, policy.<file>,
+// appliqués au scénario par défaut.
+struct SweepParameter {
+    string name;
+    vector<string> values;
+    double low = 0.0;
+    double high = 0.0;
+    bool isRange = false;
+};
+
+struct SweepSpace {
+    vector<SweepParameter> parameters;
+    size_t samples = 0;
+    unsigned seed = 42;
+};
+
+// Indice de file d'un paramètre « weight.<file> » / « policy.<file> », -1 sinon
+int sweepQueueIndex(const string &name, const string &prefix, size_t queueCount) {
+    if(name.compare(0, prefix.size(), prefix) != 0) return -1;
+    const char *first = name.data() + prefix.size(), *last = name.data() + name.size();
+    size_t qi;
+    auto [end, ec] = from_chars(first, last, qi);
+    if(first == last || ec != errc() || end != last) return -1;
+    return qi < queueCount ? (int)qi : -1;
+}
+
+// Valeur numérique d'un paramètre : tout le texte est un nombre fini,
+// strictement positif pour unit et resource (un quantum nul ne termine
+// jamais), positif ou nul sinon (aging, agingFactor, weight.<file>)
+bool sweepNumber(const string &name, const string &text, double &value) {
+    auto [end, ec] = from_chars(text.data(), text.data() + text.size(), value);
+    if(text.empty() || ec != errc() || end != text.data() + text.size() || !isfinite(value)) return false;
+    return name == "unit" || name == "resource" ? value > 0 : value >= 0;
+}
+
+template<class Integer>
+bool sweepInteger(const string &text, Integer &value) {
+    auto [end, ec] = from_chars(text.data(), text.data() + text.size(), value);
+    return !text.empty() && ec == errc() && end == text.data() + text.size();
+}
+
+bool parseSweepSpace(istream &in, size_t queueCount, SweepSpace &space, string &error) {
+    string line;
+    int lineNumber = 0;
+    while(getline(in, line)) {
+        lineNumber++;
+        line = line.substr(0, line.find('#'));
+        istringstream fields(line);
+        string name, value;
+        if(!(fields >> name)) continue;
+        if(!(fields >> value)) {
+            error = "ligne " + to_string(lineNumber) + ": valeur manquante pour " + name;
+            return false;
+        }
+        auto invalid = [&](const string &what, const string &text) {
+            error = "ligne " + to_string(lineNumber) + ": " + what + " invalide pour " + name + ": " + text;
+            return false;
+        };
+        if(name == "samples") {
+            if(!sweepInteger(value, space.samples)) return invalid("valeur", value);
+            continue;
+        }
+        if(name == "seed") {
+            if(!sweepInteger(value, space.seed)) return invalid("valeur", value);
+            continue;
+        }
+
+        bool known = name == "unit" || name == "resource" || name == "aging" || name == "agingFactor"
+                     || sweepQueueIndex(name, "weight.", queueCount) >= 0
+                     || sweepQueueIndex(name, "policy.", queueCount) >= 0;
+        if(!known) {
+            error = "ligne " + to_string(lineNumber) + ": paramètre inconnu " + name;
+            return false;
+        }
+
+        SweepParameter param;
+        param.name = name;
+        size_t colon = value.find(':');
+        bool policy = name.compare(0, 7, "policy.") == 0;
+        if(colon != string::npos && !policy) {
+            param.isRange = true;
+            if(!sweepNumber(name, value.substr(0, colon), param.low) ||
+               !sweepNumber(name, value.substr(colon + 1), param.high) || param.low > param.high) {
+                return invalid("intervalle", value);
+            }
+        } else {
+            stringstream list(value);
+            string item;
+            while(getline(list, item, ',')) {
+                if(policy && PolicyRegistry::find(item) < 0) {
+                    error = "ligne " + to_string(lineNumber) + ": politique inconnue " + item;
+                    return false;
+                }
+                double number;
+                if(!policy && !sweepNumber(name, item, number)) return invalid("valeur", item);
+                param.values.push_back(item);
+            }
+            if(param.values.empty()) return invalid("valeur", value);
+        }
+        space.parameters.push_back(param);
+    }
+
+    if(space.samples == 0) {
+        for(const auto &param : space.parameters) {
+            if(param.isRange) {
+                error = "intervalle " + param.name + " sans « samples » : grille impossible";
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Points du balayage, tirés d'avance pour qu'un même fichier donne les mêmes runs
+vector<vector<string>> expandSweep(const SweepSpace &space) {
+    vector<vector<string>> points;
+    if(space.samples > 0) {
+        mt19937 rng(space.seed);
+        for(size_t r = 0; r < space.samples; r++) {
+            vector<string> point;
+            for(const auto &param : space.parameters) {
+                if(param.isRange) {
+                    ostringstream text;
+                    text << uniform_real_distribution<double>(param.low, param.high)(rng);
+                    point.push_back(text.str());
+                } else {
+                    point.push_back(param.values[rng() % param.values.size()]);
+                }
+            }
+            points.push_back(point);
+        }
+        return points;
+    }
+
+    size_t total = 1;
+    for(const auto &param : space.parameters) total *= param.values.size();
+    for(size_t r = 0; r < total; r++) {
+        vector<string> point;
+        size_t rest = r;
+        for(const auto &param : space.parameters) {
+            point.push_back(param.values[rest % param.values.size()]);
+            rest /= param.values.size();
+        }
+        points.push_back(point);
+    }
+    return points;
+}
+
+// Scénario commun à tous les points : trois files par défaut ou --workload,
+// ressource de --resource, ressources DRF de --resources
+struct SweepBase {
+    string workloadPath;
+    double resource = 100.0;
+    vector<string> resourceNames;
+    vector<double> capacities;
+    bool weightedDrf = true;
+};
+
+// Une instance indépendante : pas de fichier, pas de terminal. Le scénario
+// est relu pour chaque point (le chargeur projette le fichier, la lecture
+// est faite en parallèle par les threads du balayage).
+RunSummary runSweepPoint(const SweepSpace &space, const SweepBase &base, const vector<string> &values,
+                         bool eventDriven) {
+    double unit = 10.0, resource = base.resource, agingFactor = 0.05;
+    bool aging = true;
+    for(size_t k = 0; k < values.size(); k++) {
+        const string &name = space.parameters[k].name;
+        double number = 0.0;        // valeurs vérifiées par parseSweepSpace
+        sweepNumber(name, values[k], number);
+        if(name == "unit") unit = number;
+        else if(name == "resource") resource = number;
+        else if(name == "aging") aging = number != 0;
+        else if(name == "agingFactor") agingFactor = number;
+    }
+
+    ResourceAllocator allocator(resource, "", "");
+    allocator.setAging(aging, agingFactor);
+    allocator.setHistoryRetention(1);      // seuls les agrégats du résumé servent
+    string error;
+    LoadStats load;
+    if(base.workloadPath.empty()) {
+        for(auto &q : defaultQueues()) allocator.addQueue(q);
+    } else {
+        loadWorkload(base.workloadPath, allocator, load, error);    // déjà lu sans erreur par runSweep
+    }
+    if(!base.resourceNames.empty()) {
+        allocator.setResources(base.resourceNames, base.capacities, base.weightedDrf, error);
+    }
+    for(size_t k = 0; k < values.size(); k++) {
+        const string &name = space.parameters[k].name;
+        double number = 0.0;
+        sweepNumber(name, values[k], number);
+        int qi;
+        if((qi = sweepQueueIndex(name, "weight.", allocator.queueCount())) >= 0) allocator.setQueueWeight(qi, number);
+        else if((qi = sweepQueueIndex(name, "policy.", allocator.queueCount())) >= 0) {
+            allocator.setQueuePolicy(qi, values[k]);
+        }
+    }
+    return eventDriven ? allocator.runEventDriven(unit) : allocator.runHeadless(unit);
+}
+
+// Une ligne CSV par run sur la sortie standard, dans l'ordre des points
+int runSweep(const string &path, const SweepBase &base, unsigned threads, bool eventDriven) {
+    ifstream in(path);
+    if(!in) {
+        cerr << "Balayage: impossible d'ouvrir " << path << "\n";
+        return 1;
+    }
+    // Scénario lu une première fois : erreurs signalées avant les runs, et
+    // nombre de files pour les paramètres weight.<file> / policy.<file>
+    ResourceAllocator probe(base.resource, "", "");
+    LoadStats load;
+    string error;
+    if(base.workloadPath.empty()) {
+        for(auto &q : defaultQueues()) probe.addQueue(q);
+    } else if(!loadWorkload(base.workloadPath, probe, load, error)) {
+        cerr << "Balayage: " << error << "\n";
+        return 1;
+    }
+    if(!base.resourceNames.empty() &&
+       !probe.setResources(base.resourceNames, base.capacities, base.weightedDrf, error)) {
+        cerr << "Balayage: " << error << "\n";
+        return 1;
+    }
+    size_t queueCount = probe.queueCount();
+    SweepSpace space;
+    if(!parseSweepSpace(in, queueCount, space, error)) {
+        cerr << "Balayage: " << error << "\n";
+        return 1;
+    }
+
+    vector<vector<string>> points = expandSweep(space);
+    vector<RunSummary> results(points.size());
+    if(threads == 0) threads = max(1u, thread::hardware_concurrency());
+
+    auto start = chrono::steady_clock::now();
+    ThreadPool pool(threads);
+    pool.parallelFor(points.size(), 1, [&](size_t begin, size_t end) {
+        for(size_t r = begin; r < end; r++) results[r] = runSweepPoint(space, base, points[r], eventDriven);
+    });
+    double wall = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << "run";
+    for(const auto &param : space.parameters) cout << "," << param.name;
+    cout << ",cycles,mean_utilization,wall_s";
+    for(size_t qi = 0; qi < queueCount; qi++) cout << ",q" << qi << "_done";
+    cout << "\n";
+    for(size_t r = 0; r < points.size(); r++) {
+        const RunSummary &summary = results[r];
+        cout << r;
+        for(const auto &value : points[r]) cout << "," << value;
+        cout << "," << summary.cycles << "," << fixed << setprecision(3) << summary.meanUtilization
+             << "," << setprecision(6) << summary.wallSeconds;
+        cout.unsetf(ios::floatfield);
+        for(int done : summary.queueCompletion) cout << "," << done;
+        cout << "\n";
+    }
+    cerr << "runs=" << points.size() << " threads=" << pool.size()
+         << " wall_s=" << fixed << setprecision(3) << wall
+         << " runs_per_s=" << setprecision(1) << (wall > 0 ? points.size() / wall : 0.0) << "\n";
+    return 0;
+}
+
+// ==================== MAIN ====================
+// SIM4_NO_MAIN : le fichier est inclus comme bibliothèque (bench_kernels.cpp)
+#ifndef SIM4_NO_MAIN
+void printUsage(ostream &out) {
+    out << "Usage: Sim4 [options]\n"
+        << "  --headless | --event | --live [FPS]      moteur seul, événementiel, vue plafonnée\n"
+        << "  --threads N | --shards N                 passes parallèles, moteur fragmenté (0 : tous les cœurs)\n"
+        << "  --workload FICHIER | --arrivals SPEC     scénario CSV/JSON, arrivées générées\n"
+        << "  --resource R | --resources nom=cap,...   ressource totale (> 0), ressources DRF\n"
+        << "  --drf weighted|plain                     parts dominantes pondérées ou non\n"
+        << "  --history N | --history-downsample F     historique borné\n"
+        << "  --async-log [block|drop]                 journal écrit par un thread dédié\n"
+        << "  --trace FICHIER | --trace-to-json T J    trace binaire, conversion en JSON\n"
+        << "  --checkpoint CYCLE FICHIER | --restore FICHIER | --what-if CYCLE SPEC\n"
+        << "  --sweep FICHIER                          balayage de paramètres\n"
+        << "  --serve SOCKET|- | --serve-load SOCKET [CLIENTS] [ITÉRATIONS]\n"
+        << "  --bench-soa [N] | --bench-threads [Q] | --bench-shards [Q] [S] | --bench-submit [P]\n"
+        << "  --bench-policy [Q] | --bench-tree [FILES] | --bench-aging [Q] | --bench-drf [P]\n"
+        << "  --bench-snapshot [P]\n";
+}
+
+// Options reconnues et nombre de valeurs obligatoires qui les suivent. Les
+// valeurs facultatives (--live, --async-log, --bench-*, --serve-load) ne
+// sont lues que si l'argument suivant n'est pas lui-même une option.
+const map<string, int> OptionArity = {
+    {"--headless", 0}, {"--event", 0}, {"--live", 0}, {"--threads", 1}, {"--shards", 1},
+    {"--bench-soa", 0}, {"--bench-threads", 0}, {"--bench-shards", 0}, {"--bench-submit", 0},
+    {"--bench-policy", 0}, {"--bench-tree", 0}, {"--bench-aging", 0}, {"--bench-drf", 0},
+    {"--bench-snapshot", 0}, {"--sweep", 1}, {"--async-log", 0}, {"--history", 1},
+    {"--history-downsample", 1}, {"--workload", 1}, {"--resource", 1}, {"--resources", 1},
+    {"--drf", 1}, {"--serve", 1}, {"--serve-load", 1}, {"--checkpoint", 2}, {"--restore", 1},
+    {"--what-if", 2}, {"--arrivals", 1}, {"--trace", 1}, {"--trace-to-json", 2},
+};
+
+// Valeur d'option entière : tout l'argument est un entier dans les bornes du type
+template<class Integer>
+bool optionInteger(const char *text, Integer &value) {
+    const char *end = text + strlen(text);
+    auto result = from_chars(text, end, value);
+    return text != end && result.ec == errc() && result.ptr == end;
+}
+
+int main(int argc, char* argv[]) {
+    // --headless : moteur seul, sans terminal ni pauses (traitements batch)
+    bool headless = false;
+    bool eventDriven = false;
+    unsigned threads = 1;
+    bool threadsGiven = false;
+    unsigned shards = 1;
+    bool shardsGiven = false;
+    string sweepPath;
+    string tracePath;
+    string workloadPath;
+    string arrivalText;
+    string servePath;
+    string resourcesText;
+    bool weightedDrf = true;
+    string restorePath;
+    string checkpointPath;
+    int checkpointCycle = 0;
+    string whatIfSpec;
+    int whatIfCycle = 0;
+    double resource = 100.0;
+    size_t historyWindow = 0;
+    size_t historyDownsample = 0;
+    bool asyncLogging = false;
+    double liveFps = 0.0;
+    LogOverflow overflow = LogOverflow::Block;
+    // Ligne de commande refusée : message, rappel des options, code 1
+    auto usageError = [](const string &message) {
+        cerr << "Options: " << message << "\n";
+        printUsage(cerr);
+        return 1;
+    };
+    auto invalid = [&](const string &option, const char *text) {
+        return usageError("valeur invalide pour " + option + ": " + text);
     };
+    // Valeur facultative présente en position k
+    auto hasValue = [&](int k) { return k < argc && strncmp(argv[k], "--", 2) != 0; };
+    // Commande autonome (--bench-*, --serve-load, --trace-to-json) : lancée
+    // une fois toute la ligne de commande vérifiée
+    function<int()> command;
+    for(int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        auto known = OptionArity.find(arg);
+        if(known == OptionArity.end()) return usageError("option inconnue: " + arg);
+        if(i + known->second >= argc) return usageError("valeur manquante pour " + arg);
+        if(arg == "--headless") headless = true;
+        // --event : moteur événementiel (implique --headless)
+        if(arg == "--event") headless = eventDriven = true;
+        // --live [FPS] : moteur seul avec vue terminal plafonnée (30 trames/s par défaut)
+        if(arg == "--live") {
+            headless = true;
+            liveFps = 30.0;
+            if(hasValue(i + 1)) {
+                if(!parseWorkloadNumber(argv[++i], liveFps) || liveFps <= 0) return invalid(arg, argv[i]);
+            }
+        }
+        // --bench-soa [N] : réductions AoS contre SoA vectorisée (1M processus par défaut)
+        if(arg == "--bench-soa") {
+            size_t n = 1000000;
+            if(hasValue(i + 1) && !optionInteger(argv[++i], n)) return invalid(arg, argv[i]);
+            command = [=] { runSoaBenchmark(n); return 0; };
+            continue;
+        }
+        // --threads N : passes d'allocation par file sur N threads (0 : tous les cœurs)
+        if(arg == "--threads") {
+            if(!optionInteger(argv[++i], threads)) return invalid(arg, argv[i]);
+            threadsGiven = true;
+        }
+        // --shards N : moteur pas à pas réparti sur N processus (0 : un par cœur ; implique --headless)
+        if(arg == "--shards") {
+            if(!optionInteger(argv[++i], shards)) return invalid(arg, argv[i]);
+            shardsGiven = headless = true;
+        }
+        // --bench-threads [Q] : débit du moteur selon le nombre de threads (4000 files par défaut)
+        if(arg == "--bench-threads") {
+            size_t queueCount = 4000;
+            if(hasValue(i + 1) && !optionInteger(argv[++i], queueCount)) return invalid(arg, argv[i]);
+            command = [=] { runThreadScalingBenchmark(queueCount); return 0; };
+            continue;
+        }
+        // --bench-shards [Q] [S] : débit du moteur fragmenté jusqu'à S processus (4000 files, S : un par cœur)
+        if(arg == "--bench-shards") {
+            size_t queueCount = 4000;
+            unsigned maxShards = 0;
+            if(hasValue(i + 1) && !optionInteger(argv[++i], queueCount)) return invalid(arg, argv[i]);
+            if(hasValue(i + 1) && !optionInteger(argv[++i], maxShards)) return invalid(arg, argv[i]);
+            command = [=] { runShardScalingBenchmark(queueCount, maxShards); return 0; };
+            continue;
+        }
+        // --bench-submit [P] : soumissions concurrentes de P threads pendant les cycles (4 par défaut)
+        if(arg == "--bench-submit") {
+            unsigned producers = 4;
+            if(hasValue(i + 1) && !optionInteger(argv[++i], producers)) return invalid(arg, argv[i]);
+            command = [=] { runSubmissionBenchmark(max(1u, producers)); return 0; };
+            continue;
+        }
+        // --bench-policy [Q] : répartition des politiques, plages contre chaînes
+        if(arg == "--bench-policy") {
+            size_t queueCount = 20000;
+            if(hasValue(i + 1) && !optionInteger(argv[++i], queueCount)) return invalid(arg, argv[i]);
+            command = [=] { runPolicyDispatchBenchmark(queueCount); return 0; };
+            continue;
+        }
+        // --bench-tree [FILES] : évaluation incrémentale de la hiérarchie (100000 files par défaut)
+        if(arg == "--bench-tree") {
+            size_t leafCount = 100000;
+            if(hasValue(i + 1) && !optionInteger(argv[++i], leafCount)) return invalid(arg, argv[i]);
+            command = [=] { runHierarchyBenchmark(leafCount); return 0; };
+            continue;
+        }
+        // --bench-aging [Q] : attentes RR contre PRIO sur charge déséquilibrée (100 files par défaut)
+        if(arg == "--bench-aging") {
+            size_t queueCount = 100;
+            if(hasValue(i + 1) && !optionInteger(argv[++i], queueCount)) return invalid(arg, argv[i]);
+            command = [=] { runAgingBenchmark(queueCount); return 0; };
+            continue;
+        }
+        // --bench-drf [P] : coût d'une tranche DRF selon le nombre de ressources (10000 processus par défaut)
+        if(arg == "--bench-drf") {
+            size_t processCount = 10000;
+            if(hasValue(i + 1) && !optionInteger(argv[++i], processCount)) return invalid(arg, argv[i]);
+            command = [=] { runDrfBenchmark(processCount); return 0; };
+            continue;
+        }
+        // --bench-snapshot [P] : instantané à mi-parcours, restauration, variantes par fork (200000 processus)
+        if(arg == "--bench-snapshot") {
+            size_t processCount = 200000;
+            if(hasValue(i + 1) && !optionInteger(argv[++i], processCount)) return invalid(arg, argv[i]);
+            command = [=] { runSnapshotBenchmark(processCount); return 0; };
+            continue;
+        }
+        // --sweep FICHIER : balayage de paramètres, un run par cœur (voir --threads,
+        // --event) ; scénario de --workload, --resource et --resources
+        if(arg == "--sweep") sweepPath = argv[++i];
+        // --async-log [block|drop] : journal et JSON écrits par un thread dédié
+        if(arg == "--async-log") {
+            asyncLogging = true;
+            if(hasValue(i + 1)) {
+                string mode = argv[++i];
+                if(mode != "block" && mode != "drop") return invalid(arg, argv[i]);
+                overflow = mode == "drop" ? LogOverflow::Drop : LogOverflow::Block;
+            }
+        }
+        // --history N : garde les N derniers cycles ; --history-downsample F :
+        // regroupe les plus anciens par paquets de F cycles
+        if(arg == "--history" && !optionInteger(argv[++i], historyWindow)) return invalid(arg, argv[i]);
+        if(arg == "--history-downsample" && !optionInteger(argv[++i], historyDownsample)) {
+            return invalid(arg, argv[i]);
+        }
+        // --workload FICHIER : scénario CSV ou JSON à la place des trois files
+        // par défaut ; --resource R : ressource totale (100 par défaut)
+        if(arg == "--workload") workloadPath = argv[++i];
+        if(arg == "--resource") {
+            if(!parseWorkloadNumber(argv[++i], resource) || resource <= 0) return invalid(arg, argv[i]);
+        }
+        // --resources nom=cap,... : allocation multi-ressources DRF (--drf
+        // weighted, par défaut : parts dominantes divisées par le poids des
+        // files ; plain : sans poids)
+        if(arg == "--resources") resourcesText = argv[++i];
+        if(arg == "--drf") {
+            string mode = argv[++i];
+            if(mode != "weighted" && mode != "plain") return invalid(arg, argv[i]);
+            weightedDrf = mode == "weighted";
+        }
+        // --serve SOCKET|- : démon d'allocation (socket Unix, ou stdin/stdout avec -)
+        if(arg == "--serve") {
+            servePath = argv[++i];
+            headless = true;
+        }
+        // --serve-load SOCKET [CLIENTS] [ITÉRATIONS] : client de charge du démon
+        if(arg == "--serve-load") {
+            string socketPath = argv[++i];
+            unsigned clients = 4;
+            size_t iterations = 10000;
+            if(hasValue(i + 1) && !optionInteger(argv[++i], clients)) return invalid(arg, argv[i]);
+            if(hasValue(i + 1) && !optionInteger(argv[++i], iterations)) return invalid(arg, argv[i]);
+            command = [=] { return runServiceLoad(socketPath, max(1u, clients), iterations); };
+            continue;
+        }
+        // --checkpoint CYCLE FICHIER : instantané après le cycle CYCLE (moteur
+        // pas à pas jusque-là) ; --restore FICHIER : reprise d'un instantané à
+        // la place du scénario
+        if(arg == "--checkpoint") {
+            if(!optionInteger(argv[++i], checkpointCycle) || checkpointCycle < 0) return invalid(arg, argv[i]);
+            checkpointPath = argv[++i];
+            headless = true;
+        }
+        if(arg == "--restore") restorePath = argv[++i];
+        // --what-if CYCLE SPEC : variantes de poids à partir du cycle CYCLE (voir VARIANTES)
+        if(arg == "--what-if") {
+            if(!optionInteger(argv[++i], whatIfCycle) || whatIfCycle < 0) return invalid(arg, argv[i]);
+            whatIfSpec = argv[++i];
+            headless = true;
+        }
+        // --arrivals SPEC : arrivées dynamiques générées (poisson|bursty,clé=valeur...)
+        if(arg == "--arrivals") arrivalText = argv[++i];
+        // --trace FICHIER : trace binaire à la place de allocation_data.json
+        if(arg == "--trace") tracePath = argv[++i];
+        // --trace-to-json TRACE JSON : reconstruit le JSON d'une trace binaire
+        if(arg == "--trace-to-json") {
+            string trace = argv[++i], json = argv[++i];
+            command = [=] {
+                string error;
+                if(!convertTraceToJson(trace, json, error)) {
+                    cerr << "Trace: " << error << "\n";
+                    return 1;
+                }
+                return 0;
+            };
+        }
+    }
+
+    if(command) return command();
+
+    if(!sweepPath.empty()) {
+        SweepBase base;
+        base.workloadPath = workloadPath;
+        base.resource = resource;
+        base.weightedDrf = weightedDrf;
+        string error;
+        if(!arrivalText.empty() || !restorePath.empty()) error = "--sweep exclut --arrivals et --restore";
+        if(error.empty() && !resourcesText.empty()) {
+            parseResourceSpec(resourcesText, base.resourceNames, base.capacities, error);
+        }
+        if(!error.empty()) {
+            cerr << "Balayage: " << error << "\n";
+            return 1;
+        }
+        return runSweep(sweepPath, base, threadsGiven ? threads : 0, eventDriven);
+    }
+
+    if(!headless) {
+        Display::clearScreen();
+        Display::printBanner(cout);
+        cout << "\n\033[1;37m🔧 Configuration du système...\033[0m\n\n";
+    }
+
+    // Le démon n'écrit ni journal ni JSON (durée de vie illimitée)
+    bool serving = !servePath.empty();
+    ResourceAllocator allocator(resource, serving ? "" : "allocation_log.txt",
+                                serving || !tracePath.empty() ? "" : "allocation_data.json");
+    if(!tracePath.empty() && !allocator.enableTrace(tracePath)) {
+        cerr << "Trace: impossible d'écrire " << tracePath << "\n";
+        return 1;
+    }
+
+    if(!restorePath.empty()) {
+        string error;
+        auto start = chrono::steady_clock::now();
+        if(!workloadPath.empty() || !arrivalText.empty()) error = "--restore exclut --workload et --arrivals";
+        if(!error.empty() || !allocator.loadSnapshot(restorePath, error)) {
+            cerr << "Instantané: " << error << "\n";
+            return 1;
+        }
+        cerr << "restore=" << restorePath << " cycle=" << allocator.cycle() << " queues=" << allocator.queueCount()
+             << " processes=" << allocator.processCount() << " restore_s=" << fixed << setprecision(4)
+             << chrono::duration<double>(chrono::steady_clock::now() - start).count() << "\n";
+        cerr.unsetf(ios::floatfield);
+        cerr.precision(6);
+    } else if(!arrivalText.empty()) {
+        ArrivalSpec spec;
+        string error;
+        if(!workloadPath.empty()) error = "--arrivals et --workload sont exclusifs";
+        if(!error.empty() || !parseArrivalSpec(arrivalText, spec, error)) {
+            cerr << "Arrivées: " << error << "\n";
+            return 1;
+        }
+        auto start = chrono::steady_clock::now();
+        vector<Queue> generated = generateArrivalScenario(spec, threadsGiven ? threads : 0);
+        for(auto &q : generated) allocator.addQueue(q);
+        cerr << "arrivals=" << arrivalText << " queues=" << allocator.queueCount()
+             << " processes=" << allocator.processCount()
+             << " gen_s=" << fixed << setprecision(3)
+             << chrono::duration<double>(chrono::steady_clock::now() - start).count() << "\n";
+        cerr.unsetf(ios::floatfield);
+        cerr.precision(6);
+    } else if(workloadPath.empty()) {
+        for(auto &q : defaultQueues()) allocator.addQueue(q);
+    } else {
+        LoadStats load;
+        string error;
+        if(!loadWorkload(workloadPath, allocator, load, error)) {
+            cerr << "Scénario: " << error << "\n";
+            return 1;
+        }
+        double seconds = max(load.seconds, 1e-9);
+        cerr << "workload=" << workloadPath << " queues=" << load.queues
+             << " processes=" << load.processes
+             << " load_s=" << fixed << setprecision(3) << load.seconds
+             << " mb_per_s=" << setprecision(1) << load.bytes / 1e6 / seconds
+             << " rows_per_s=" << setprecision(0) << load.rows / seconds << "\n";
+        cerr.unsetf(ios::floatfield);
+        cerr.precision(6);
+    }
+    if(!resourcesText.empty()) {
+        vector<string> names;
+        vector<double> capacities;
+        string error;
+        if(!parseResourceSpec(resourcesText, names, capacities, error) ||
+           !allocator.setResources(names, capacities, weightedDrf, error)) {
+            cerr << "Ressources: " << error << "\n";
+            return 1;
+        }
+    }
+    allocator.setThreads(threads);
+    // Un instantané apporte son historique (et sa rétention)
+    if(restorePath.empty() || historyWindow > 0) {
+        allocator.setHistoryRetention(serving && historyWindow == 0 ? 1024 : historyWindow, historyDownsample);
+    }
+    allocator.setProfileOutput("allocation_profile.txt");
+    if(asyncLogging) allocator.enableAsyncLogging(1 << 16, overflow);
+    if(liveFps > 0) allocator.enableLiveView(liveFps);
+
+    if(serving) {
+        return servePath == "-" ? runServicePipe(allocator) : runServiceSocket(allocator, servePath);
+    }
+
+    if(!whatIfSpec.empty()) {
+        return runWhatIf(allocator, whatIfCycle, whatIfSpec, threadsGiven ? threads : 0, 10.0);
+    }
+
+    if(!checkpointPath.empty()) {
+        string error;
+        auto start = chrono::steady_clock::now();
+        allocator.advanceTo(checkpointCycle, 10.0);
+        if(!allocator.writeSnapshot(checkpointPath, error)) {
+            cerr << "Instantané: " << error << "\n";
+            return 1;
+        }
+        cerr << "checkpoint=" << checkpointPath << " cycle=" << allocator.cycle() << " s="
+             << fixed << setprecision(4) << chrono::duration<double>(chrono::steady_clock::now() - start).count()
+             << "\n";
+        cerr.unsetf(ios::floatfield);
+        cerr.precision(6);
+    }
 
-    allocator.addQueue(q1);
-    allocator.addQueue(q2);
-    allocator.addQueue(q3);
+    if(headless) {
+        RunSummary summary;
+        if(shardsGiven) {
+            string error;
+            summary = allocator.runSharded(10.0, shards, error);
+            if(!error.empty()) {
+                cerr << "Fragments: " << error << "\n";
+                return 1;
+            }
+        } else {
+            summary = eventDriven ? allocator.runEventDriven(10.0) : allocator.runHeadless(10.0);
+        }
+        cout << "cycles=" << summary.cycles
+             << " wall_s=" << fixed << setprecision(6) << summary.wallSeconds
+             << " cycles_per_s=" << setprecision(1) << summary.cyclesPerSecond
+             << " mean_response=" << setprecision(2) << summary.meanResponse
+             << " mean_wait=" << summary.meanWait << " max_wait=" << summary.maxWait << "\n";
+        return 0;
+    }
 
-    cout << "  ✓ 3 files configurées\n";
-    cout << "  ✓ 6 processus initialisés\n";
-    cout << "  ✓ Ressource totale: 100.0 unités\n\n";
+    cout << "  ✓ " << allocator.queueCount() << " files configurées\n";
+    cout << "  ✓ " << allocator.processCount() << " processus initialisés\n";
+    ostringstream resourceText;
+    resourceText << fixed << setprecision(1) << resource;
+    cout << "  ✓ Ressource totale: " << resourceText.str() << " unités\n\n";
 
     // Lancement de la simulation
     allocator.simulate(10.0, 2000, false); // quantum=10, délai=2s, mode manuel
 
     return 0;
 }
+#endif
@@ -26,6 +26,21 @@ struct Queue {
     double aging = 0.0;  // facteur d'augmentation de priorité
     vector<Process> processes;
 
+    // Tenue incrémentale (DynamicScheduler) : seuls les processus actifs sont
+    // suivis. Chaque actif reçoit la même part par cycle ; `drained` cumule ces
+    // parts, et un processus termine quand drained atteint son seuil (reste à
+    // l'entrée). Des parts égales préservent l'ordre des restes : triés par
+    // seuil, les processus qui terminent forment toujours un préfixe.
+    int activeCount = 0;
+    double backlog = 0.0;         // somme des restes des actifs
+    double drained = 0.0;
+    vector<double> threshold;     // par processus : reste + drained à l'entrée
+    vector<int> byThreshold;      // actifs par seuil croissant à partir de head
+    size_t head = 0;
+    vector<int> activeOrder;      // actifs dans l'ordre des processus (traces)
+    int servedCycles = 0;         // cycles où la file a été servie
+    vector<int> finishedAt;       // par processus terminé : servedCycles - waitTime
+
     Queue(string n, double w, double c)
         : name(n), baseWeight(w), cap(c) {}
 
@@ -42,95 +57,210 @@ private:
     double totalResource;
     double agingRate;
     double redistributionFactor;
+    ostream &out;              // sortie des traces (flux sans tampon : muet)
+    long long allocations = 0; // allocations à un processus depuis le début
+    int activeQueues = 0;
+
+    double finishedCapShare = 0.0;  // somme des parts de plafond des files terminées
+
+    // Remplissage par niveau pondéré (max-min) : chaque file active reçoit
+    // min(limite, poids × λ), λ choisi pour distribuer toute la ressource si
+    // les limites le permettent. Les files triées par limite / poids, celles
+    // qui saturent sortent une à une : O(Q log Q).
+    void waterFill(const vector<int> &active, const vector<double> &limit,
+                   const vector<double> &weight, vector<double> &alloc) const {
+        vector<int> order;
+        double weightLeft = 0.0;
+        for (int qi : active) {
+            if (weight[qi] > 0) {
+                order.push_back(qi);
+                weightLeft += weight[qi];
+            } else {
+                alloc[qi] = 0.0;
+            }
+        }
+        sort(order.begin(), order.end(), [&](int a, int b) {
+            return limit[a] * weight[b] < limit[b] * weight[a];
+        });
+
+        double left = totalResource;
+        size_t k = 0;
+        for (; k < order.size(); ++k) {
+            int qi = order[k];
+            if (limit[qi] > weight[qi] * (left / weightLeft)) break;
+            alloc[qi] = limit[qi];
+            left -= limit[qi];
+            weightLeft -= weight[qi];
+        }
+        for (size_t j = k; j < order.size(); ++j) {
+            int qi = order[j];
+            alloc[qi] = left * (weight[qi] / weightLeft);
+        }
+    }
+
+    // Part égale alloc / actifs pour chaque actif d'une file : ceux dont le
+    // reste est sous la part terminent (leur surplus n'est pas redistribué),
+    // les autres reçoivent la part. Coût proportionnel aux processus qui
+    // terminent ; retourne le nombre de processus servis.
+    int distribute(Queue &q, double alloc) {
+        const double epsilon = 1e-9;    // reste résiduel d'arrondi : terminé
+        int served = q.activeCount;
+        double share = alloc / q.activeCount, used = 0.0;
+        size_t end = q.byThreshold.size();
+        q.servedCycles++;
+        while (q.head < end) {
+            int i = q.byThreshold[q.head];
+            double need = q.threshold[i] - q.drained;
+            if (need > share + epsilon) break;
+            used += need;
+            q.processes[i].remaining = 0.0;
+            q.finishedAt[i] = q.servedCycles;
+            q.head++;
+            q.activeCount--;
+        }
+        q.drained += share;
+        used += share * q.activeCount;
+        q.backlog = q.activeCount > 0 ? max(0.0, q.backlog - used) : 0.0;
+        return served;
+    }
+
+    // Traces des processus actifs d'une file dans leur ordre (seul parcours
+    // complet, sauté quand le flux est muet) : un processus qui termine
+    // utilise son reste, les autres la part
+    void traceProcesses(Queue &q, double drainedBefore, double share) {
+        size_t kept = 0;
+        for (int i : q.activeOrder) {
+            Process &p = q.processes[i];
+            double used = p.remaining > 0 ? share : q.threshold[i] - drainedBefore;
+            if (p.remaining > 0) p.remaining = q.threshold[i] - q.drained;
+            out << "  " << p.name << " utilise " << used
+                << " (reste: " << p.remaining << ")\n";
+            if (p.remaining > 0) q.activeOrder[kept++] = i;
+        }
+        q.activeOrder.resize(kept);
+    }
+
+    // Restes et attentes à jour (après run) : un actif servi n'attend pas, un
+    // processus terminé attend à chaque cycle où sa file est encore servie
+    void syncProcesses() {
+        for (auto &q : queues) {
+            for (size_t k = q.head; k < q.byThreshold.size(); ++k) {
+                int i = q.byThreshold[k];
+                q.processes[i].remaining = q.threshold[i] - q.drained;
+                if (q.servedCycles > 0) q.processes[i].waitTime = 0;
+            }
+            for (size_t i = 0; i < q.processes.size(); ++i)
+                if (q.processes[i].remaining <= 0)
+                    q.processes[i].waitTime = q.servedCycles - q.finishedAt[i];
+        }
+    }
 
 public:
-    DynamicScheduler(double totalRes, double ageRate = 0.1, double redist = 0.2)
-        : totalResource(totalRes), agingRate(ageRate), redistributionFactor(redist) {}
+    DynamicScheduler(double totalRes, double ageRate = 0.1, double redist = 0.2, ostream &output = cout)
+        : totalResource(totalRes), agingRate(ageRate), redistributionFactor(redist), out(output) {}
+
+    long long allocationCount() const { return allocations; }
 
     void addQueue(const Queue &q) {
         queues.push_back(q);
+        Queue &added = queues.back();
+        size_t n = added.processes.size();
+        added.threshold.assign(n, 0.0);
+        added.finishedAt.assign(n, 0);
+        added.byThreshold.clear();
+        added.activeOrder.clear();
+        added.head = 0;
+        added.drained = 0.0;
+        added.backlog = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            double remaining = added.processes[i].remaining;
+            if (remaining <= 0) {
+                added.finishedAt[i] = added.servedCycles - added.processes[i].waitTime;
+                continue;
+            }
+            added.threshold[i] = remaining;
+            added.byThreshold.push_back(i);
+            added.activeOrder.push_back(i);
+            added.backlog += remaining;
+        }
+        stable_sort(added.byThreshold.begin(), added.byThreshold.end(),
+                    [&](int a, int b) { return added.threshold[a] < added.threshold[b]; });
+        added.activeCount = added.byThreshold.size();
+        if (added.activeCount > 0) activeQueues++;
     }
-
     void run(int cycles) {
-        cout << fixed << setprecision(2);
+        out << fixed << setprecision(2);
+        bool tracing = out.rdbuf() != nullptr;
+        size_t count = queues.size();
+        vector<int> active;
+        vector<double> weight(count), limit(count), alloc(count);
 
         for (int t = 1; t <= cycles; ++t) {
-            cout << "\n=== Cycle " << t << " ===\n";
+            out << "\n=== Cycle " << t << " ===\n";
 
-            // Étape 1 : Calcul du poids effectif (avec aging)
-            double totalWeight = 0.0;
-            for (auto &q : queues) {
-                if (!q.allFinished()) {
-                    totalWeight += (q.baseWeight + q.aging);
-                }
+            // Étape 1 : Poids effectif (avec aging) et limite (plafond, reste
+            // à servir) des files actives
+            active.clear();
+            for (size_t qi = 0; qi < count; ++qi) {
+                Queue &q = queues[qi];
+                if (q.activeCount == 0) continue;
+                active.push_back(qi);
+                weight[qi] = q.baseWeight + q.aging;
+                limit[qi] = min(q.cap, q.backlog);
             }
 
-            // Étape 2 : Allocation initiale
-            for (auto &q : queues) {
-                if (q.allFinished()) continue;
-
-                double effectiveWeight = q.baseWeight + q.aging;
-                double alloc = totalResource * (effectiveWeight / totalWeight);
-                alloc = min(q.cap, alloc);
+            // Étape 2 : Allocation par remplissage pondéré ; la part des files
+            // saturées revient aux autres dans la limite de leur plafond
+            waterFill(active, limit, weight, alloc);
 
-                cout << "\n[Queue " << q.name << "] reçoit " << alloc << " unités.\n";
+            for (int qi : active) {
+                Queue &q = queues[qi];
+                out << "\n[Queue " << q.name << "] reçoit " << alloc[qi] << " unités.\n";
 
                 // Étape 3 : Distribution interne (Round Robin simplifié)
-                int activeCount = 0;
-                for (auto &p : q.processes)
-                    if (p.remaining > 0) activeCount++;
-
-                if (activeCount == 0) continue;
-
-                double perProcess = alloc / activeCount;
-
-                for (auto &p : q.processes) {
-                    if (p.remaining > 0) {
-                        double used = min(p.remaining, perProcess);
-                        p.remaining -= used;
-                        p.waitTime = 0;
-                        cout << "  " << p.name << " utilise " << used
-                             << " (reste: " << p.remaining << ")\n";
-                    } else {
-                        p.waitTime++;
-                    }
-                }
+                double drainedBefore = q.drained, share = alloc[qi] / q.activeCount;
+                allocations += distribute(q, alloc[qi]);
+                if (tracing) traceProcesses(q, drainedBefore, share);
 
                 // Étape 4 : Famine (si la file n’a pas eu assez de ressources)
-                if (alloc < 0.1 * q.cap) {
+                if (alloc[qi] < 0.1 * q.cap) {
                     q.aging += agingRate;
-                    cout << "  ⚠️  Famine détectée → aging augmenté à " << q.aging << "\n";
+                    out << "  ⚠️  Famine détectée → aging augmenté à " << q.aging << "\n";
                 } else {
                     // Réinitialisation progressive de l'aging
                     q.aging = max(0.0, q.aging - 0.05);
                 }
-            }
 
-            // Étape 5 : Redistribution (files terminées)
-            double unused = 0.0;
-            for (auto &q : queues)
-                if (q.allFinished()) unused += q.cap * redistributionFactor;
+                if (q.activeCount == 0) {
+                    activeQueues--;
+                    finishedCapShare += q.cap * redistributionFactor;
+                }
+            }
 
+            // Étape 5 : Redistribution (files terminées), partagée entre les
+            // seules files actives
+            double unused = finishedCapShare;
             if (unused > 0) {
-                cout << "\nRedistribution de " << unused << " unités inutilisées.\n";
-                for (auto &q : queues)
-                    if (!q.allFinished())
-                        q.cap += unused / queues.size();
+                out << "\nRedistribution de " << unused << " unités inutilisées.\n";
+                if (activeQueues > 0)
+                    for (auto &q : queues)
+                        if (q.activeCount > 0)
+                            q.cap += unused / activeQueues;
             }
 
             // Étape 6 : Affichage de l’état global
-            cout << "\nÉtat global des files :\n";
+            out << "\nÉtat global des files :\n";
             for (auto &q : queues) {
-                cout << "  " << q.name << " → aging=" << q.aging
-                     << ", cap=" << q.cap << "\n";
+                out << "  " << q.name << " → aging=" << q.aging
+                    << ", cap=" << q.cap << "\n";
             }
         }
+        syncProcesses();
     }
 };
 
-int main() {
-    DynamicScheduler scheduler(100.0);
-
+// Scénario de démonstration (main, rejeu de ses traces par replay_trace.cpp)
+void addDemoQueues(DynamicScheduler &scheduler) {
     Queue high("HIGH", 3.0, 50.0);
     high.processes = { Process("P1", 40, 1.0), Process("P2", 25, 1.0) };
 
@@ -143,6 +273,13 @@ int main() {
     scheduler.addQueue(high);
     scheduler.addQueue(medium);
     scheduler.addQueue(low);
+}
 
+// SIMULATOR2_NO_MAIN : le fichier est inclus comme bibliothèque (bench_kernels.cpp, replay_trace.cpp)
+#ifndef SIMULATOR2_NO_MAIN
+int main() {
+    DynamicScheduler scheduler(100.0);
+    addDemoQueues(scheduler);
     scheduler.run(15);
 }
+#endif
@@ -0,0 +1,232 @@
+//
+// Microbenchmarks des noyaux d'allocation, sans terminal ni journaux :
+//   rr, fifo, wfq,  files d'une seule politique (RoundRobinPolicy / FifoPolicy /
+//   prio            WeightedFairPolicy / PriorityPolicy de Sim4.cpp)
+//   cycle           files RR et FIFO entrelacées : runCycle complet (quotas, groupes, stats)
+//   dynamic         DynamicScheduler::run de Simulator2.cpp, traces muettes
+//
+// Une ligne clé=valeur par mesure (meilleur de --repeat exécutions) :
+//   kernel=rr queues=1000 processes_per_queue=100 ratio=0.1 cycles=... allocations=...
+//   wall_s=... ns_per_allocation=... cycles_per_s=... allocations_per_cycle=...
+//
+// Paramètres (listes séparées par des virgules, produit cartésien) :
+//   --queues 100,1000   --processes 10,100   --ratio 0.1,1   (quantum / quota moyen)
+//   --kernels rr,fifo,wfq,prio,cycle,dynamic   --repeat 3   --cycles 200 (dynamic seulement)
+//
+// DynamicScheduler n'a pas de quantum : ses lignes portent ratio=na et durent --cycles.
+//
+
+// Les en-têtes standard sont inclus ici, hors des espaces de noms ci-dessous :
+// les inclusions des deux simulateurs sont alors sans effet.
+#include <iostream>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iomanip>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <map>
+#include <unordered_map>
+#include <sstream>
+#include <ctime>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <limits>
+#include <queue>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <charconv>
+#include <string_view>
+#include <array>
+#include <bit>
+#include <cerrno>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/ioctl.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
+
+#if defined(__linux__)
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <csignal>
+#endif
+
+// Les deux simulateurs définissent Process et Queue : un espace de noms chacun
+#define SIM4_NO_MAIN
+#define SIMULATOR2_NO_MAIN
+namespace sim4 {
+#include "Sim4.cpp"
+}
+namespace sim2 {
+#include "Simulator2.cpp"
+}
+
+using namespace std;
+
+struct BenchResult {
+    long long cycles = 0;
+    long long allocations = 0;
+    double wallSeconds = 0.0;
+};
+
+struct BenchConfig {
+    vector<double> queues = {100, 1000};
+    vector<double> processes = {10, 100};
+    vector<double> ratios = {0.1, 1.0};
+    vector<string> kernels = {"rr", "fifo", "wfq", "prio", "cycle", "dynamic"};
+    int repeat = 3;
+    int dynamicCycles = 200;
+};
+
+const double ShareUnits = 100.0;        // quota moyen d'une file
+
+// Sim4 : une exécution headless jusqu'à la fin des processus
+BenchResult runSim4(const string &kernel, size_t queueCount, size_t processesPerQueue, double ratio) {
+    sim4::ResourceAllocator allocator(queueCount * ShareUnits, "", "");
+    allocator.setHistoryRetention(1);
+    string policy = kernel == "rr" ? "RR" : kernel == "fifo" ? "FIFO" : kernel == "wfq" ? "WFQ"
+                  : kernel == "prio" ? "PRIO" : "";
+    sim4::addSyntheticQueues(allocator, queueCount, processesPerQueue, policy);
+    sim4::RunSummary summary = allocator.runHeadless(ratio * ShareUnits);
+    return {summary.cycles, summary.allocations, summary.wallSeconds};
+}
+
+// Simulator2 : mêmes files (poids, demandes), plafond à deux fois la part moyenne
+BenchResult runDynamic(size_t queueCount, size_t processesPerQueue, int cycles) {
+    ostream silent(nullptr);
+    sim2::DynamicScheduler scheduler(queueCount * ShareUnits, 0.1, 0.2, silent);
+    mt19937 rng(42);
+    uniform_real_distribution<double> demand(10.0, 100.0);
+    for(size_t qi = 0; qi < queueCount; qi++) {
+        sim2::Queue q("Q" + to_string(qi), 0.1 + (qi % 10) / 10.0, 2 * ShareUnits);
+        q.processes.reserve(processesPerQueue);
+        for(size_t i = 0; i < processesPerQueue; i++) {
+            q.processes.emplace_back(q.name + "_P" + to_string(i), demand(rng), 1.0);
+        }
+        scheduler.addQueue(q);
+    }
+    auto start = chrono::steady_clock::now();
+    scheduler.run(cycles);
+    double wall = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return {cycles, scheduler.allocationCount(), wall};
+}
+
+void report(const string &kernel, size_t queueCount, size_t processesPerQueue, const string &ratio,
+            const BenchResult &r) {
+    double cycles = max<long long>(1, r.cycles);
+    double allocations = max<long long>(1, r.allocations);
+    cout << "kernel=" << kernel << " queues=" << queueCount << " processes_per_queue=" << processesPerQueue
+         << " ratio=" << ratio << " cycles=" << r.cycles << " allocations=" << r.allocations
+         << fixed << setprecision(6) << " wall_s=" << r.wallSeconds
+         << setprecision(2) << " ns_per_allocation=" << r.wallSeconds * 1e9 / allocations
+         << setprecision(1) << " cycles_per_s=" << r.cycles / max(r.wallSeconds, 1e-12)
+         << setprecision(2) << " allocations_per_cycle=" << r.allocations / cycles << "\n";
+    cout.unsetf(ios::floatfield);
+}
+
+bool parseList(const string &text, vector<double> &values, string &error) {
+    values.clear();
+    stringstream list(text);
+    string item;
+    while(getline(list, item, ',')) {
+        char *end = nullptr;
+        double value = strtod(item.c_str(), &end);
+        if(item.empty() || *end != '\0' || !(value > 0)) {
+            error = "valeur invalide: " + item;
+            return false;
+        }
+        values.push_back(value);
+    }
+    if(values.empty()) error = "liste vide";
+    return !values.empty();
+}
+
+bool parseArguments(int argc, char *argv[], BenchConfig &config, string &error) {
+    for(int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if(i + 1 >= argc) {
+            error = "valeur manquante pour " + arg;
+            return false;
+        }
+        string value = argv[++i];
+        if(arg == "--queues") {
+            if(!parseList(value, config.queues, error)) return false;
+        } else if(arg == "--processes") {
+            if(!parseList(value, config.processes, error)) return false;
+        } else if(arg == "--ratio") {
+            if(!parseList(value, config.ratios, error)) return false;
+        } else if(arg == "--kernels") {
+            config.kernels.clear();
+            stringstream list(value);
+            string kernel;
+            while(getline(list, kernel, ',')) {
+                if(kernel != "rr" && kernel != "fifo" && kernel != "wfq" && kernel != "prio" && kernel != "cycle" && kernel != "dynamic") {
+                    error = "noyau inconnu: " + kernel;
+                    return false;
+                }
+                config.kernels.push_back(kernel);
+            }
+        } else if(arg == "--repeat") {
+            config.repeat = max(1, atoi(value.c_str()));
+        } else if(arg == "--cycles") {
+            config.dynamicCycles = max(1, atoi(value.c_str()));
+        } else {
+            error = "option inconnue: " + arg;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    BenchConfig config;
+    string error;
+    if(!parseArguments(argc, argv, config, error)) {
+        cerr << "Benchmark: " << error << "\n";
+        return 1;
+    }
+
+    for(const string &kernel : config.kernels) {
+        for(double queues : config.queues) {
+            for(double processes : config.processes) {
+                size_t queueCount = queues, processesPerQueue = processes;
+                if(kernel == "dynamic") {
+                    BenchResult best;
+                    for(int r = 0; r < config.repeat; r++) {
+                        BenchResult run = runDynamic(queueCount, processesPerQueue, config.dynamicCycles);
+                        if(r == 0 || run.wallSeconds < best.wallSeconds) best = run;
+                    }
+                    report(kernel, queueCount, processesPerQueue, "na", best);
+                    continue;
+                }
+                for(double ratio : config.ratios) {
+                    BenchResult best;
+                    for(int r = 0; r < config.repeat; r++) {
+                        BenchResult run = runSim4(kernel, queueCount, processesPerQueue, ratio);
+                        if(r == 0 || run.wallSeconds < best.wallSeconds) best = run;
+                    }
+                    ostringstream label;
+                    label << ratio;
+                    report(kernel, queueCount, processesPerQueue, label.str(), best);
+                }
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,646 @@
+//
+// Rejeu déterministe d'une trace enregistrée : le scénario est relancé dans
+// un ou plusieurs moteurs, leurs allocations sont comparées cycle par cycle
+// à l'enregistrement, et le débit de chaque moteur est mesuré.
+//
+//   replay_trace --trace allocation_data.json [--workload scenario.csv] [--resource R] [--unit 10]
+//                [--engines step,threads,async,event,shards] [--threads 4] [--shards 4]
+//                [--repeat 3] [--show 5] [--tolerance 0]
+//   replay_trace --trace simulator2.log --engines dynamic
+//
+// Traces reconnues (détectées au contenu) :
+//   allocation_data.json   JSON de Sim4.cpp ; valeurs à 6 chiffres significatifs
+//   trace binaire          --trace de Sim4.cpp (S4TRACE1) ; valeurs exactes
+//   sortie de Simulator2   texte du DynamicScheduler ; valeurs à 2 décimales
+// Une valeur rejouée est mise en forme comme la trace l'aurait écrite avant
+// comparaison : l'égalité est exacte, au format de la trace près, sauf
+// --tolerance (écart relatif admis entre deux valeurs, 0 par défaut). Une
+// trace vide ou réduite à son en-tête est une exécution de zéro cycle.
+//
+// Le scénario vient de --workload (CSV ou JSON, comme Sim4 --workload) ou des
+// trois files par défaut ; la ressource totale de la trace sert sauf --resource.
+// Moteurs de Sim4.cpp :
+//   step      pas à pas, série (référence du débit relatif)
+//   threads   pas à pas, passes par file sur --threads threads
+//   async     pas à pas, journal mis en forme par le thread écrivain
+//   event     moteur événementiel : pas de trace par allocation, comparaison
+//             par processus (total alloué, cycle de fin) ; totaux identiques
+//             au bit près à ceux du pas à pas
+//   shards    pas à pas réparti sur --shards processus (fork) : sans trace
+//             (elle le ramènerait à un processus), comparé par processus
+//             comme event
+// Moteur de Simulator2.cpp :
+//   dynamic   DynamicScheduler sur son scénario de démonstration
+//
+// Une ligne clé=valeur pour la trace, puis une par moteur :
+//   engine=step mode=records cycles=... records=... divergent_cycles=0 divergent_records=0
+//   first_divergence=- max_abs_diff=0 wall_s=... cycles_per_s=... allocations_per_s=... relative=1.00
+// suivie des premières divergences (--show). Code de sortie 2 si un moteur diverge.
+//
+
+// Les en-têtes standard sont inclus ici, hors des espaces de noms ci-dessous :
+// les inclusions des deux simulateurs sont alors sans effet.
+#include <iostream>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iomanip>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include <ctime>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <limits>
+#include <queue>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <charconv>
+#include <string_view>
+#include <array>
+#include <bit>
+#include <cerrno>
+#include <filesystem>
+#include <unordered_map>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/ioctl.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
+
+#if defined(__linux__)
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <csignal>
+#endif
+
+// Les deux simulateurs définissent Process et Queue : un espace de noms chacun
+#define SIM4_NO_MAIN
+#define SIMULATOR2_NO_MAIN
+namespace sim4 {
+#include "Sim4.cpp"
+}
+namespace sim2 {
+#include "Simulator2.cpp"
+}
+
+using namespace std;
+
+enum class TraceFormat { Json, Binary, Sim2Text };
+
+const char *formatName(TraceFormat format) {
+    return format == TraceFormat::Json ? "json" : format == TraceFormat::Binary ? "binary" : "simulator2";
+}
+
+// Valeur telle que la trace l'aurait écrite : flux par défaut (6 chiffres
+// significatifs) pour le JSON, fixed à 2 décimales pour Simulator2, exacte
+// pour la trace binaire
+double quantize(TraceFormat format, double value) {
+    if(format == TraceFormat::Binary) return value;
+    char text[64];
+    auto written = format == TraceFormat::Json ? to_chars(text, text + sizeof text, value, chars_format::general, 6)
+                                               : to_chars(text, text + sizeof text, value, chars_format::fixed, 2);
+    double parsed = value;
+    from_chars(text, written.ptr, parsed);
+    return parsed;
+}
+
+// Files et processus désignés par leur nom (un processus par nom dans sa
+// file) : identifiants communs à la trace et aux moteurs
+class NameTable {
+public:
+    int queue(string_view name) {
+        auto [it, added] = queueIds.try_emplace(string(name), (int)queueNames.size());
+        if(added) queueNames.emplace_back(name);
+        return it->second;
+    }
+
+    int process(int queue, string_view name) {
+        string key = to_string(queue) + '\x1f' + string(name);
+        auto [it, added] = processIds.try_emplace(key, (int)processNames.size());
+        if(added) processNames.push_back(queueNames[queue] + "/" + string(name));
+        return it->second;
+    }
+
+    const string &queueName(int id) const { return queueNames[id]; }
+    const string &processName(int id) const { return processNames[id]; }
+
+private:
+    unordered_map<string, int> queueIds;
+    unordered_map<string, int> processIds;
+    vector<string> queueNames;
+    vector<string> processNames;
+};
+
+// Quota d'une file (process = -1) ou allocation à un processus, dans l'ordre
+// d'écriture du moteur
+struct Record {
+    int cycle;
+    int queue;
+    int process;
+    double amount;
+};
+
+struct Recording {
+    TraceFormat format = TraceFormat::Json;
+    double totalResource = 0.0;     // 0 : absente (Simulator2)
+    vector<Record> records;
+    int cycles = 0;
+};
+
+// ---------- Lecture des traces ----------
+
+// Trace d'une exécution arrêtée avant son premier cycle, écrite sans en-tête
+bool emptyFile(const string &path) {
+    error_code failure;
+    return filesystem::file_size(path, failure) == 0 && !failure;
+}
+
+bool parseNumber(string_view text, double &value) {
+    size_t start = text.find_first_not_of(' ');
+    if(start == string_view::npos) return false;
+    auto result = from_chars(text.data() + start, text.data() + text.size(), value);
+    return result.ec == errc();
+}
+
+// allocation_data.json, ligne à ligne dans la mise en page de JsonLayout
+// (l'horodatage contient un saut de ligne : le fichier n'est pas lu comme du
+// JSON générique)
+bool readJsonTrace(string_view data, NameTable &names, Recording &recording, string &error) {
+    int cycle = 0, queue = -1;
+    size_t lineNumber = 0;
+    while(!data.empty()) {
+        size_t eol = min(data.find('\n'), data.size());
+        string_view line = data.substr(0, eol);
+        data.remove_prefix(min(eol + 1, data.size()));
+        lineNumber++;
+        auto fail = [&](const char *what) {
+            error = "ligne " + to_string(lineNumber) + ": " + what;
+            return false;
+        };
+        size_t at;
+        double value;
+        if((at = line.find("{\"process\": \"")) != string_view::npos) {
+            size_t nameStart = at + 13;
+            size_t nameEnd = line.rfind("\", \"allocated\": ");
+            if(queue < 0 || nameEnd == string_view::npos || nameEnd < nameStart ||
+               !parseNumber(line.substr(nameEnd + 16), value)) {
+                return fail("allocation illisible");
+            }
+            recording.records.push_back({cycle, queue, names.process(queue, line.substr(nameStart, nameEnd - nameStart)), value});
+        } else if((at = line.find("\"queue\": \"")) != string_view::npos) {
+            size_t nameEnd = line.rfind('"');
+            if(nameEnd <= at + 10) return fail("nom de file illisible");
+            queue = names.queue(line.substr(at + 10, nameEnd - at - 10));
+        } else if((at = line.find("\"quota\": ")) != string_view::npos) {
+            if(queue < 0 || !parseNumber(line.substr(at + 9), value)) return fail("quota illisible");
+            recording.records.push_back({cycle, queue, -1, value});
+        } else if((at = line.find("\"cycle\": ")) != string_view::npos) {
+            if(!parseNumber(line.substr(at + 9), value)) return fail("cycle illisible");
+            cycle = (int)value;
+            queue = -1;
+            recording.cycles = max(recording.cycles, cycle);
+        } else if((at = line.find("\"totalResource\": ")) != string_view::npos) {
+            if(!parseNumber(line.substr(at + 17), recording.totalResource)) return fail("ressource illisible");
+        }
+    }
+    return true;
+}
+
+bool readBinaryTrace(const string &path, NameTable &names, Recording &recording, string &error) {
+    if(emptyFile(path)) return true;
+    sim4::TraceReader trace;
+    if(!trace.open(path, error)) return false;
+    recording.totalResource = trace.totalResource;
+    vector<int> queueIds, processIds;
+    for(const auto &name : trace.queueNames) queueIds.push_back(names.queue(name));
+    for(size_t p = 0; p < trace.processNames.size(); p++) {
+        processIds.push_back(names.process(queueIds[trace.processQueues[p]], trace.processNames[p]));
+    }
+    recording.records.reserve(trace.recordCount);
+    for(const auto &block : trace.blocks) {
+        for(size_t r = 0; r < block.count; r++) {
+            int process = block.process[r] < 0 ? -1 : processIds[block.process[r]];
+            recording.records.push_back({block.cycle[r], queueIds[block.queue[r]], process, block.amount[r]});
+            recording.cycles = max(recording.cycles, block.cycle[r]);
+        }
+    }
+    return true;
+}
+
+// Sortie du DynamicScheduler : « === Cycle N === », « [Queue X] reçoit A
+// unités. », « ␣␣P utilise A (reste: R) »
+bool readSim2Trace(string_view data, NameTable &names, Recording &recording, string &error) {
+    int cycle = 0, queue = -1;
+    while(!data.empty()) {
+        size_t eol = min(data.find('\n'), data.size());
+        string_view line = data.substr(0, eol);
+        data.remove_prefix(min(eol + 1, data.size()));
+        double value;
+        size_t at;
+        if(line.rfind("=== Cycle ", 0) == 0) {
+            if(!parseNumber(line.substr(10), value)) { error = "cycle illisible"; return false; }
+            cycle = (int)value;
+            queue = -1;
+            recording.cycles = max(recording.cycles, cycle);
+        } else if(line.rfind("[Queue ", 0) == 0 && (at = line.find("] reçoit ")) != string_view::npos) {
+            queue = names.queue(line.substr(7, at - 7));
+            if(!parseNumber(line.substr(at + strlen("] reçoit ")), value)) { error = "quota illisible"; return false; }
+            recording.records.push_back({cycle, queue, -1, value});
+        } else if(line.rfind("  ", 0) == 0 && (at = line.find(" utilise ")) != string_view::npos && queue >= 0) {
+            if(!parseNumber(line.substr(at + 9), value)) { error = "allocation illisible"; return false; }
+            recording.records.push_back({cycle, queue, names.process(queue, line.substr(2, at - 2)), value});
+        }
+    }
+    return true;
+}
+
+bool readTrace(const string &path, NameTable &names, Recording &recording, string &error) {
+    if(emptyFile(path)) {
+        recording.format = TraceFormat::Binary;
+        return true;
+    }
+    sim4::MappedFile file;
+    if(!file.open(path, error)) return false;
+    string_view data(file.data(), file.size());
+    if(data.rfind("S4TRACE1", 0) == 0) {
+        recording.format = TraceFormat::Binary;
+        return readBinaryTrace(path, names, recording, error);
+    }
+    size_t first = data.find_first_not_of(" \t\r\n");
+    if(first != string_view::npos && data[first] == '{') {
+        recording.format = TraceFormat::Json;
+        return readJsonTrace(data, names, recording, error);
+    }
+    if(data.find("=== Cycle ") != string_view::npos) {
+        recording.format = TraceFormat::Sim2Text;
+        return readSim2Trace(data, names, recording, error);
+    }
+    error = path + " : ni JSON de Sim4, ni trace binaire, ni sortie de Simulator2";
+    return false;
+}
+
+// ---------- Moteurs ----------
+
+struct ReplayConfig {
+    string tracePath;
+    string workloadPath;
+    double resource = 0.0;          // 0 : celle de la trace
+    double unit = 10.0;
+    vector<string> engines;         // vide : selon le format de la trace
+    unsigned threads = 4;
+    unsigned shards = 4;
+    int repeat = 3;
+    size_t shown = 5;
+    double tolerance = 0.0;         // écart relatif admis (0 : égalité exacte)
+};
+
+struct EngineRun {
+    bool perRecord = true;          // faux : comparaison par processus
+    vector<Record> records;
+    map<int, pair<double, int>> totals;     // processus -> (alloué, cycle de fin ou -1)
+    int cycles = 0;
+    long long allocations = 0;
+    double wallSeconds = 0.0;       // meilleur de --repeat, sans enregistrement
+};
+
+bool isSim4Engine(const string &engine) {
+    return engine == "step" || engine == "threads" || engine == "async" || engine == "event" || engine == "shards";
+}
+
+// Moteurs sans trace par allocation : comparaison par processus
+bool perProcessEngine(const string &engine) {
+    return engine == "event" || engine == "shards";
+}
+
+bool buildSim4(const ReplayConfig &config, const string &engine, sim4::ResourceAllocator &allocator, string &error) {
+    allocator.setHistoryRetention(1);
+    if(config.workloadPath.empty()) {
+        for(auto &q : sim4::defaultQueues()) allocator.addQueue(q);
+    } else {
+        sim4::LoadStats load;
+        if(!sim4::loadWorkload(config.workloadPath, allocator, load, error)) return false;
+    }
+    if(engine == "threads") allocator.setThreads(config.threads);
+    if(engine == "async") allocator.enableAsyncLogging();
+    return true;
+}
+
+// Faux si un fragment du moteur réparti a échoué
+bool runSim4(sim4::ResourceAllocator &allocator, const string &engine, const ReplayConfig &config,
+             sim4::RunSummary &summary, string &error) {
+    if(engine == "shards") summary = allocator.runSharded(config.unit, config.shards, error);
+    else summary = engine == "event" ? allocator.runEventDriven(config.unit) : allocator.runHeadless(config.unit);
+    return error.empty();
+}
+
+// Passe enregistrée (trace binaire du moteur, relue) puis passes chronométrées
+bool replaySim4(const ReplayConfig &config, const string &engine, double resource, NameTable &names,
+                EngineRun &run, string &error) {
+    run.perRecord = !perProcessEngine(engine);
+    sim4::RunSummary summary;
+    if(run.perRecord) {
+        string path = (filesystem::temp_directory_path() /
+                       ("replay_" + engine + "_" + to_string(getpid()) + ".trace")).string();
+        {
+            sim4::ResourceAllocator allocator(resource, "", "");
+            if(!buildSim4(config, engine, allocator, error)) return false;
+            if(!allocator.enableTrace(path)) {
+                error = "impossible d'écrire " + path;
+                return false;
+            }
+            runSim4(allocator, engine, config, summary, error);
+        }
+        Recording replayed;
+        bool ok = readBinaryTrace(path, names, replayed, error);
+        filesystem::remove(path);
+        if(!ok) return false;
+        run.records = move(replayed.records);
+    } else {
+        sim4::ResourceAllocator allocator(resource, "", "");
+        if(!buildSim4(config, engine, allocator, error) || !runSim4(allocator, engine, config, summary, error)) {
+            return false;
+        }
+        for(size_t qi = 0; qi < allocator.queueCount(); qi++) {
+            const sim4::Queue &q = allocator.queueAt(qi);
+            int queue = names.queue(q.name);
+            for(const auto &p : q.processes) {
+                run.totals[names.process(queue, p.name)] = {p.allocated, p.finished ? p.endCycle : -1};
+            }
+        }
+    }
+
+    for(int r = 0; r < config.repeat; r++) {
+        sim4::ResourceAllocator allocator(resource, "", "");
+        if(!buildSim4(config, engine, allocator, error) || !runSim4(allocator, engine, config, summary, error)) {
+            return false;
+        }
+        if(r == 0 || summary.wallSeconds < run.wallSeconds) run.wallSeconds = summary.wallSeconds;
+        run.cycles = summary.cycles;
+        run.allocations = summary.allocations;
+    }
+    return true;
+}
+
+bool replayDynamic(const ReplayConfig &config, int cycles, double resource, NameTable &names, EngineRun &run,
+                   string &error) {
+    ostringstream out;
+    {
+        sim2::DynamicScheduler scheduler(resource, 0.1, 0.2, out);
+        sim2::addDemoQueues(scheduler);
+        scheduler.run(cycles);
+    }
+    Recording replayed;
+    if(!readSim2Trace(out.str(), names, replayed, error)) return false;
+    run.records = move(replayed.records);
+
+    ostream silent(nullptr);
+    for(int r = 0; r < config.repeat; r++) {
+        sim2::DynamicScheduler scheduler(resource, 0.1, 0.2, silent);
+        sim2::addDemoQueues(scheduler);
+        auto start = chrono::steady_clock::now();
+        scheduler.run(cycles);
+        double wall = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        if(r == 0 || wall < run.wallSeconds) run.wallSeconds = wall;
+        run.allocations = scheduler.allocationCount();
+    }
+    run.cycles = cycles;
+    return true;
+}
+
+// ---------- Comparaison ----------
+
+struct Comparison {
+    long long compared = 0;         // enregistrements ou processus
+    long long divergentCycles = 0;
+    long long divergent = 0;
+    int firstCycle = -1;
+    double maxAbsDiff = 0.0;
+    vector<string> details;
+};
+
+string describe(const NameTable &names, const Record *record) {
+    if(!record) return "absent";
+    ostringstream text;
+    text << (record->process < 0 ? names.queueName(record->queue) + "/quota" : names.processName(record->process))
+         << "=" << record->amount;
+    return text.str();
+}
+
+bool withinTolerance(double expected, double actual, double tolerance) {
+    return expected == actual || fabs(expected - actual) <= tolerance * max(fabs(expected), fabs(actual));
+}
+
+// Cycle par cycle, enregistrement par enregistrement, dans l'ordre d'écriture
+Comparison compareRecords(const Recording &reference, const vector<Record> &replayed, const NameTable &names,
+                          size_t shown, double tolerance) {
+    Comparison result;
+    const vector<Record> &expected = reference.records;
+    result.compared = expected.size();
+    size_t a = 0, b = 0;
+    while(a < expected.size() || b < replayed.size()) {
+        int cycle = min(a < expected.size() ? expected[a].cycle : INT32_MAX,
+                        b < replayed.size() ? replayed[b].cycle : INT32_MAX);
+        size_t aEnd = a, bEnd = b;
+        while(aEnd < expected.size() && expected[aEnd].cycle == cycle) aEnd++;
+        while(bEnd < replayed.size() && replayed[bEnd].cycle == cycle) bEnd++;
+        long long before = result.divergent;
+        for(size_t k = 0; k < max(aEnd - a, bEnd - b); k++) {
+            const Record *x = a + k < aEnd ? &expected[a + k] : nullptr;
+            const Record *y = b + k < bEnd ? &replayed[b + k] : nullptr;
+            Record rounded = y ? *y : Record{};
+            rounded.amount = quantize(reference.format, rounded.amount);
+            bool sameTarget = x && y && x->queue == y->queue && x->process == y->process;
+            if(sameTarget) result.maxAbsDiff = max(result.maxAbsDiff, fabs(x->amount - rounded.amount));
+            if(sameTarget && withinTolerance(x->amount, rounded.amount, tolerance)) continue;
+            result.divergent++;
+            if(result.details.size() < shown) {
+                result.details.push_back("divergence cycle=" + to_string(cycle) + " position=" + to_string(k) +
+                                         " expected=" + describe(names, x) + " actual=" + describe(names, y ? &rounded : nullptr));
+            }
+        }
+        if(result.divergent > before) {
+            result.divergentCycles++;
+            if(result.firstCycle < 0) result.firstCycle = cycle;
+        }
+        a = aEnd;
+        b = bEnd;
+    }
+    return result;
+}
+
+// Moteurs event et shards : total alloué et cycle de la dernière allocation (fin)
+// par processus. Les totaux JSON sont des sommes de valeurs arrondies à
+// 6 chiffres : écart relatif toléré d'au moins 5e-6 ; exacts pour la trace
+// binaire, sauf --tolerance.
+Comparison compareTotals(const Recording &reference, const map<int, pair<double, int>> &totals,
+                         const NameTable &names, size_t shown, double tolerance) {
+    Comparison result;
+    map<int, pair<double, int>> expected;
+    for(const auto &record : reference.records) {
+        if(record.process < 0) continue;
+        auto &total = expected[record.process];
+        total.first += record.amount;
+        total.second = max(total.second, record.cycle);
+    }
+    if(reference.format != TraceFormat::Binary) tolerance = max(tolerance, 5e-6);
+    vector<int> cycles;
+    for(const auto &[process, actual] : totals) {
+        result.compared++;
+        auto found = expected.find(process);
+        pair<double, int> want = found == expected.end() ? pair<double, int>{0.0, 0} : found->second;
+        double diff = fabs(want.first - actual.first);
+        result.maxAbsDiff = max(result.maxAbsDiff, diff);
+        bool totalOk = withinTolerance(want.first, actual.first, tolerance);
+        bool endOk = actual.second < 0 || actual.second == want.second;
+        if(totalOk && endOk) continue;
+        result.divergent++;
+        int cycle = endOk ? want.second : min(want.second, actual.second);
+        cycles.push_back(cycle);
+        if(result.firstCycle < 0 || cycle < result.firstCycle) result.firstCycle = cycle;
+        if(result.details.size() < shown) {
+            ostringstream text;
+            text << "divergence process=" << names.processName(process) << " expected_total=" << want.first
+                 << " actual_total=" << actual.first << " expected_end=" << want.second
+                 << " actual_end=" << actual.second;
+            result.details.push_back(text.str());
+        }
+    }
+    sort(cycles.begin(), cycles.end());
+    result.divergentCycles = unique(cycles.begin(), cycles.end()) - cycles.begin();
+    return result;
+}
+
+// ---------- Ligne de commande ----------
+
+bool parseArguments(int argc, char *argv[], ReplayConfig &config, string &error) {
+    for(int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if(i + 1 >= argc) {
+            error = "valeur manquante pour " + arg;
+            return false;
+        }
+        string value = argv[++i];
+        if(arg == "--trace") {
+            config.tracePath = value;
+        } else if(arg == "--workload") {
+            config.workloadPath = value;
+        } else if(arg == "--resource") {
+            config.resource = atof(value.c_str());
+        } else if(arg == "--unit") {
+            config.unit = atof(value.c_str());
+        } else if(arg == "--engines") {
+            config.engines.clear();
+            stringstream list(value);
+            string engine;
+            while(getline(list, engine, ',')) {
+                if(!isSim4Engine(engine) && engine != "dynamic") {
+                    error = "moteur inconnu: " + engine;
+                    return false;
+                }
+                config.engines.push_back(engine);
+            }
+        } else if(arg == "--threads") {
+            config.threads = max(1, atoi(value.c_str()));
+        } else if(arg == "--shards") {
+            config.shards = max(1, atoi(value.c_str()));
+        } else if(arg == "--repeat") {
+            config.repeat = max(1, atoi(value.c_str()));
+        } else if(arg == "--show") {
+            config.shown = max(0, atoi(value.c_str()));
+        } else if(arg == "--tolerance") {
+            char *end = nullptr;
+            config.tolerance = strtod(value.c_str(), &end);
+            if(value.empty() || *end != '\0' || !(config.tolerance >= 0) || !isfinite(config.tolerance)) {
+                error = "tolérance invalide: " + value;
+                return false;
+            }
+        } else {
+            error = "option inconnue: " + arg;
+            return false;
+        }
+    }
+    if(config.tracePath.empty()) error = "--trace attendu";
+    else if(!(config.unit > 0)) error = "quantum invalide";
+    return error.empty();
+}
+
+int main(int argc, char *argv[]) {
+    ReplayConfig config;
+    string error;
+    if(!parseArguments(argc, argv, config, error)) {
+        cerr << "Rejeu: " << error << "\n";
+        return 1;
+    }
+
+    NameTable names;
+    Recording reference;
+    auto start = chrono::steady_clock::now();
+    if(!readTrace(config.tracePath, names, reference, error)) {
+        cerr << "Rejeu: " << error << "\n";
+        return 1;
+    }
+    double readSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    bool sim2Trace = reference.format == TraceFormat::Sim2Text;
+    if(config.engines.empty()) {
+        config.engines = sim2Trace ? vector<string>{"dynamic"} : vector<string>{"step", "threads", "async", "event", "shards"};
+    }
+    double resource = config.resource > 0 ? config.resource
+                    : reference.totalResource > 0 ? reference.totalResource : 100.0;
+    cout << "trace=" << config.tracePath << " format=" << formatName(reference.format)
+         << " cycles=" << reference.cycles << " records=" << reference.records.size()
+         << " resource=" << resource << " tolerance=" << config.tolerance
+         << fixed << setprecision(3) << " read_s=" << readSeconds << "\n";
+    cout.unsetf(ios::floatfield);
+
+    bool diverged = false;
+    double referenceRate = 0.0;
+    for(const string &engine : config.engines) {
+        if(isSim4Engine(engine) == sim2Trace) {
+            cerr << "Rejeu: moteur " << engine << " incompatible avec une trace " << formatName(reference.format) << "\n";
+            return 1;
+        }
+        EngineRun run;
+        bool ok = sim2Trace ? replayDynamic(config, reference.cycles, resource, names, run, error)
+                            : replaySim4(config, engine, resource, names, run, error);
+        if(!ok) {
+            cerr << "Rejeu: " << engine << ": " << error << "\n";
+            return 1;
+        }
+        Comparison comparison = run.perRecord ? compareRecords(reference, run.records, names, config.shown, config.tolerance)
+                                              : compareTotals(reference, run.totals, names, config.shown, config.tolerance);
+        diverged = diverged || comparison.divergent > 0;
+
+        double rate = run.cycles / max(run.wallSeconds, 1e-12);
+        if(referenceRate == 0.0) referenceRate = rate;
+        cout << "engine=" << engine << " mode=" << (run.perRecord ? "records" : "processes")
+             << " cycles=" << run.cycles << (run.perRecord ? " records=" : " processes=") << comparison.compared
+             << " divergent_cycles=" << comparison.divergentCycles
+             << (run.perRecord ? " divergent_records=" : " divergent_processes=") << comparison.divergent
+             << " first_divergence=" << (comparison.firstCycle < 0 ? string("-") : to_string(comparison.firstCycle))
+             << " max_abs_diff=" << comparison.maxAbsDiff
+             << fixed << setprecision(6) << " wall_s=" << run.wallSeconds
+             << setprecision(1) << " cycles_per_s=" << rate
+             << " allocations_per_s=" << run.allocations / max(run.wallSeconds, 1e-12)
+             << setprecision(2) << " relative=" << (referenceRate > 0 ? rate / referenceRate : 1.0) << "\n";
+        cout.unsetf(ios::floatfield);
+        for(const string &detail : comparison.details) cout << "  " << detail << "\n";
+    }
+    return diverged ? 2 : 0;
+}